@@ -0,0 +1,83 @@
+// cppgraph -- C++ call graph analyzer
+//
+//! @file Arena.cc
+//! @brief This file contains the implementation of class Arena.
+//
+// Copyright (C) 2006, by Timmy <timmy1992@gmail.com>
+//
+// This file may be distributed under the terms of the Q Public License
+// version 1.0 as appearing in the file LICENSE.QPL included in the
+// packaging of this file.
+
+#include "sys.h"
+#include <algorithm>
+#include "Arena.h"
+#include "debug.h"
+
+Arena ingestion_arena("ingestion");
+Arena analysis_arena("analysis");
+
+void* Arena::allocate(size_t size)
+{
+  size = (size + S_alignment - 1) & ~(S_alignment - 1);
+  M_in_use += size;
+  if (M_in_use > M_high_water_mark)
+    M_high_water_mark = M_in_use;
+  size_t const index = size / S_alignment;
+  if (index < M_free_lists.size() && M_free_lists[index])
+  {
+    void* block = M_free_lists[index];
+    M_free_lists[index] = *static_cast<void**>(block);
+    return block;
+  }
+  // Blocks that are larger than a quarter chunk (large vectors) get memory of their own.
+  if (size > S_chunk_size / 4)
+  {
+    M_large.push_back(::operator new(size));
+    M_large_size += size;
+    return M_large.back();
+  }
+  if (static_cast<size_t>(M_end - M_free) < size)
+  {
+    // The rest of the current chunk is lost; that is at most a quarter chunk.
+    M_free = static_cast<char*>(::operator new(S_chunk_size));
+    M_end = M_free + S_chunk_size;
+    M_chunks.push_back(M_free);
+  }
+  void* block = M_free;
+  M_free += size;
+  return block;
+}
+
+void Arena::deallocate(void* ptr, size_t size)
+{
+  size = (size + S_alignment - 1) & ~(S_alignment - 1);
+  M_in_use -= size;
+  if (size > S_chunk_size / 4)
+  {
+    // There are only a few of these: the vectors that grew beyond a quarter chunk.
+    M_large.erase(std::find(M_large.begin(), M_large.end(), ptr));
+    M_large_size -= size;
+    ::operator delete(ptr);
+    return;
+  }
+  size_t const index = size / S_alignment;
+  if (index >= M_free_lists.size())
+    M_free_lists.resize(index + 1, NULL);
+  *static_cast<void**>(ptr) = M_free_lists[index];
+  M_free_lists[index] = ptr;
+}
+
+void Arena::release(void)
+{
+  for (std::vector<char*>::iterator iter = M_chunks.begin(); iter != M_chunks.end(); ++iter)
+    ::operator delete(*iter);
+  for (std::vector<void*>::iterator iter = M_large.begin(); iter != M_large.end(); ++iter)
+    ::operator delete(*iter);
+  std::vector<char*>().swap(M_chunks);
+  std::vector<void*>().swap(M_large);
+  std::vector<void*>().swap(M_free_lists);
+  M_free = M_end = NULL;
+  M_large_size = 0;
+  M_in_use = 0;
+}
@@ -0,0 +1,97 @@
+// cppgraph -- C++ call graph analyzer
+//
+//! @file Arena.h
+//! @brief This file contains the declaration of class Arena and of template class ArenaAllocator.
+//
+// Copyright (C) 2006, by Timmy <timmy1992@gmail.com>
+//
+// This file may be distributed under the terms of the Q Public License
+// version 1.0 as appearing in the file LICENSE.QPL included in the
+// packaging of this file.
+
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <cstddef>
+#include <new>
+#include <vector>
+
+// A memory pool for the element containers, and for the vectors inside their elements.
+//
+// Memory is taken from large chunks, and freed blocks are kept on a free list per size,
+// because a container allocates nodes of only one size. The containers that use an arena
+// are never destroyed, so that exiting doesn't run a destructor for every element: at the
+// end of its phase, release returns all memory of the arena at once instead.
+//
+// Like the containers, an arena may only be used by the main thread.
+class Arena {
+public:
+  Arena(char const* name) : M_name(name), M_free(NULL), M_end(NULL), M_large_size(0), M_in_use(0), M_high_water_mark(0) { }
+
+  void* allocate(size_t size);
+  void deallocate(void* ptr, size_t size);
+
+  // Return all memory to the system. Nothing that was allocated from the arena
+  // may be used afterwards, and it must not be destroyed either.
+  void release(void);
+
+  char const* name(void) const { return M_name; }
+  // The number of bytes allocated and not deallocated.
+  size_t in_use(void) const { return M_in_use; }
+  // The largest value that in_use ever had.
+  size_t high_water_mark(void) const { return M_high_water_mark; }
+  // The number of bytes taken from the system.
+  size_t reserved(void) const { return M_chunks.size() * S_chunk_size + M_large_size; }
+
+private:
+  static size_t const S_chunk_size = 1024 * 1024;
+  static size_t const S_alignment = 16;
+
+  char const* M_name;
+  std::vector<char*> M_chunks;
+  char* M_free;				// The unused part of the last chunk, [M_free, M_end).
+  char* M_end;
+  std::vector<void*> M_free_lists;	// Indexed by size / S_alignment; linked through the first word of each block.
+  std::vector<void*> M_large;		// The blocks that are too large for a chunk.
+  size_t M_large_size;			// Their total size.
+  size_t M_in_use;
+  size_t M_high_water_mark;
+};
+
+// The nodes of FileName::container, Function::container and Edge::container,
+// the call sites of the edges and Location::container.
+extern Arena ingestion_arena;
+// The nodes of Class::container.
+extern Arena analysis_arena;
+
+// A standard allocator that allocates from 'arena'.
+template<typename T, Arena& arena>
+class ArenaAllocator {
+public:
+  typedef T value_type;
+  typedef T* pointer;
+  typedef T const* const_pointer;
+  typedef T& reference;
+  typedef T const& const_reference;
+  typedef size_t size_type;
+  typedef ptrdiff_t difference_type;
+  template<typename U>
+  struct rebind { typedef ArenaAllocator<U, arena> other; };
+
+  ArenaAllocator(void) { }
+  template<typename U>
+  ArenaAllocator(ArenaAllocator<U, arena> const&) { }
+
+  pointer address(reference x) const { return &x; }
+  const_pointer address(const_reference x) const { return &x; }
+  pointer allocate(size_type n, void const* = 0) { return static_cast<pointer>(arena.allocate(n * sizeof(T))); }
+  void deallocate(pointer p, size_type n) { arena.deallocate(p, n * sizeof(T)); }
+  size_type max_size(void) const { return size_type(-1) / sizeof(T); }
+  void construct(pointer p, T const& value) { new (p) T(value); }
+  void destroy(pointer p) { p->~T(); }
+
+  friend bool operator==(ArenaAllocator const&, ArenaAllocator const&) { return true; }
+  friend bool operator!=(ArenaAllocator const&, ArenaAllocator const&) { return false; }
+};
+
+#endif // ARENA_H
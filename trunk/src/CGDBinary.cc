@@ -0,0 +1,175 @@
+// cppgraph -- C++ call graph analyzer
+//
+//! @file CGDBinary.cc
+//! @brief This file contains the implementation of classes CGDBinaryWriter and CGDBinaryReader.
+//
+// Copyright (C) 2006, by Timmy <timmy1992@gmail.com>
+//
+// This file may be distributed under the terms of the Q Public License
+// version 1.0 as appearing in the file LICENSE.QPL included in the
+// packaging of this file.
+
+#include "sys.h"
+#include <cerrno>
+#include <cstring>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include "CGDBinary.h"
+#include "exceptions.h"
+#include "debug.h"
+
+uint32_t CGDBinaryWriter::string_index(std::string const& str)
+{
+  std::pair<std::map<std::string, uint32_t>::iterator, bool> result =
+      M_string_index.insert(std::pair<std::string, uint32_t>(str, M_strings.size()));
+  if (result.second)
+    M_strings.push_back(&result.first->first);
+  return result.first->second;
+}
+
+void CGDBinaryWriter::add(CGDRecord const& record, std::string const& curdir)
+{
+  CGDBinaryRecord binary_record;
+  binary_record.type = record.type;
+  binary_record.function = string_index(record.function);
+  std::string file(record.file);
+  CGDRecord::make_absolute(file, curdir);
+  binary_record.file = string_index(file);
+  binary_record.line_nr = record.line_nr;
+  binary_record.callee = 0;
+  binary_record.callee_file = 0;
+  if (record.type == 'C')
+  {
+    binary_record.callee = string_index(record.callee);
+    std::string callee_file(record.callee_file);
+    CGDRecord::make_absolute(callee_file, curdir);
+    binary_record.callee_file = string_index(callee_file);
+  }
+  M_records.push_back(binary_record);
+}
+
+void CGDBinaryWriter::write(std::string const& filename) const
+{
+  CGDBinaryHeader header;
+  memcpy(header.magic, "CGDB", 4);
+  header.version = CGDBinaryHeader::S_version;
+  header.byte_order_mark = CGDBinaryHeader::S_byte_order_mark;
+  header.number_of_strings = M_strings.size();
+  header.number_of_records = M_records.size();
+  std::vector<uint32_t> offsets;
+  uint32_t offset = 0;
+  for (std::vector<std::string const*>::const_iterator iter = M_strings.begin(); iter != M_strings.end(); ++iter)
+  {
+    offsets.push_back(offset);
+    offset += (*iter)->size();
+  }
+  offsets.push_back(offset);
+
+  // Write to a temporary file first, so that genfull never sees a partial .cgdb file.
+  std::string tmpname(filename + ".tmp");
+  std::ofstream out(tmpname.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+  if (out)
+  {
+    out.write(reinterpret_cast<char const*>(&header), sizeof(header));
+    out.write(reinterpret_cast<char const*>(&offsets[0]), offsets.size() * sizeof(uint32_t));
+    if (!M_records.empty())
+      out.write(reinterpret_cast<char const*>(&M_records[0]), M_records.size() * sizeof(CGDBinaryRecord));
+    for (std::vector<std::string const*>::const_iterator iter = M_strings.begin(); iter != M_strings.end(); ++iter)
+      out.write((*iter)->data(), (*iter)->size());
+    out.close();
+  }
+  if (!out)
+  {
+    int saved_errno = errno;
+    std::remove(tmpname.c_str());
+    THROW_EXCEPTION(std::runtime_error(tmpname + ": " + strerror(saved_errno)),
+	"CGDBinaryWriter::write(\"" << filename << "\"): writing failed");
+  }
+  if (std::rename(tmpname.c_str(), filename.c_str()) == -1)
+  {
+    int saved_errno = errno;
+    std::remove(tmpname.c_str());
+    THROW_EXCEPTION(std::runtime_error("rename: " + filename + ": " + strerror(saved_errno)),
+	"CGDBinaryWriter::write(\"" << filename << "\"): rename failed");
+  }
+}
+
+CGDBinaryReader::CGDBinaryReader(char const* begin, size_t size, CGDFile const& cgd_file) : M_cgd_file(cgd_file)
+{
+  std::string const& filename(cgd_file.long_name());
+  M_header = reinterpret_cast<CGDBinaryHeader const*>(begin);
+  if (size < sizeof(CGDBinaryHeader) || memcmp(M_header->magic, "CGDB", 4))
+    THROW_EXCEPTION(std::runtime_error(filename + ": not a .cgdb file."),
+	"CGDBinaryReader::CGDBinaryReader(): bad magic");
+  if (M_header->byte_order_mark != CGDBinaryHeader::S_byte_order_mark)
+    THROW_EXCEPTION(std::runtime_error(filename + ": this .cgdb file was written on a machine with a different byte order."),
+	"CGDBinaryReader::CGDBinaryReader(): byte order mark is " << std::hex << M_header->byte_order_mark);
+  if (M_header->version != CGDBinaryHeader::S_version)
+  {
+    std::ostringstream ss;
+    ss << filename << ": unsupported .cgdb version " << M_header->version << '.';
+    THROW_EXCEPTION(std::runtime_error(ss.str()), "CGDBinaryReader::CGDBinaryReader(): bad version");
+  }
+  uint32_t number_of_strings = M_header->number_of_strings;
+  uint32_t number_of_records = M_header->number_of_records;
+  // Use 64 bit arithmetic, so that a corrupt header can't cause an overflow.
+  uint64_t strings_offset = sizeof(CGDBinaryHeader) + (number_of_strings + 1ULL) * sizeof(uint32_t) +
+      static_cast<uint64_t>(number_of_records) * sizeof(CGDBinaryRecord);
+  bool corrupt = strings_offset > size;
+  if (!corrupt)
+  {
+    M_offsets = reinterpret_cast<uint32_t const*>(begin + sizeof(CGDBinaryHeader));
+    M_records = reinterpret_cast<CGDBinaryRecord const*>(M_offsets + number_of_strings + 1);
+    M_strings = begin + strings_offset;
+    corrupt = M_offsets[0] != 0 || strings_offset + M_offsets[number_of_strings] != size;
+    for (uint32_t i = 0; !corrupt && i < number_of_strings; ++i)
+      corrupt = M_offsets[i] > M_offsets[i + 1];
+  }
+  if (corrupt)
+    THROW_EXCEPTION(std::runtime_error(filename + ": truncated or corrupt .cgdb file."),
+	"CGDBinaryReader::CGDBinaryReader(): size is " << size);
+  M_functions.resize(number_of_strings);
+  M_function_done.resize(number_of_strings);
+}
+
+std::string const& CGDBinaryReader::function(uint32_t index)
+{
+  if (!M_function_done[index])
+  {
+    assign(M_functions[index], index);
+    CGDRecord::rewrite_unnamed(M_functions[index], M_cgd_file);
+    M_function_done[index] = true;
+  }
+  return M_functions[index];
+}
+
+void CGDBinaryReader::get(size_t index, CGDRecord& record, bool raw)
+{
+  CGDBinaryRecord const& binary_record(M_records[index]);
+  uint32_t const number_of_strings = M_header->number_of_strings;
+  bool is_call = binary_record.type == 'C';
+  if ((binary_record.type != 'F' && !is_call) || binary_record.line_nr == 0 ||
+      binary_record.function >= number_of_strings || binary_record.file >= number_of_strings ||
+      (is_call && (binary_record.callee >= number_of_strings || binary_record.callee_file >= number_of_strings)))
+  {
+    std::ostringstream ss;
+    ss << M_cgd_file.long_name() << ": record " << index << ": Parse error.";
+    THROW_EXCEPTION(std::runtime_error(ss.str()), "CGDBinaryReader::get(" << index << "): Parse error");
+  }
+  record.type = binary_record.type;
+  if (raw)
+    assign(record.function, binary_record.function);
+  else
+    record.function = function(binary_record.function);
+  assign(record.file, binary_record.file);
+  record.line_nr = binary_record.line_nr;
+  if (is_call)
+  {
+    if (raw)
+      assign(record.callee, binary_record.callee);
+    else
+      record.callee = function(binary_record.callee);
+    assign(record.callee_file, binary_record.callee_file);
+  }
+}
@@ -0,0 +1,106 @@
+// cppgraph -- C++ call graph analyzer
+//
+//! @file CGDBinary.h
+//! @brief This file contains the declaration of classes CGDBinaryWriter and CGDBinaryReader.
+//
+// Copyright (C) 2006, by Timmy <timmy1992@gmail.com>
+//
+// This file may be distributed under the terms of the Q Public License
+// version 1.0 as appearing in the file LICENSE.QPL included in the
+// packaging of this file.
+
+#ifndef CGDBINARY_H
+#define CGDBINARY_H
+
+#include <string>
+#include <vector>
+#include <map>
+#include <stdint.h>
+#include "CGDRecord.h"
+
+// The binary equivalent of a .cgd file, a .cgdb file, contains every string
+// only once and refers to them by index from fixed-width records.
+//
+// Layout (all integers are 32 bit, in the byte order of the machine that wrote the file):
+//
+//   header	CGDBinaryHeader
+//   offsets	number_of_strings + 1 offsets into the string data; string i is [offset[i], offset[i + 1]).
+//   records	number_of_records times CGDBinaryRecord.
+//   strings	The string data (not zero terminated).
+//
+// The strings are stored as they appear in the .cgd file, except that relative
+// paths are already made absolute.  Anonymous namespaces are not rewritten,
+// because that depends on the other input files.
+
+struct CGDBinaryHeader {
+  char magic[4];		// "CGDB"
+  uint32_t version;		// CGDBinaryHeader::S_version
+  uint32_t byte_order_mark;	// CGDBinaryHeader::S_byte_order_mark, in the byte order of the writer.
+  uint32_t number_of_strings;
+  uint32_t number_of_records;
+
+  static uint32_t const S_version = 1;
+  static uint32_t const S_byte_order_mark = 0x01020304;
+};
+
+struct CGDBinaryRecord {
+  uint32_t type;		// 'F' or 'C'.
+  uint32_t function;		// String index of the defined function, or the caller.
+  uint32_t file;		// String index of the file of the definition or call location.
+  uint32_t line_nr;		// The line number of the definition or call location.
+  uint32_t callee;		// String index of the called function (0 when type == 'F').
+  uint32_t callee_file;		// String index of the file of the callee (0 when type == 'F').
+};
+
+// Collects text records and writes them as a .cgdb file.
+class CGDBinaryWriter {
+private:
+  std::map<std::string, uint32_t> M_string_index;
+  std::vector<std::string const*> M_strings;	// Points to the keys of M_string_index.
+  std::vector<CGDBinaryRecord> M_records;
+
+public:
+  // Add a record, as returned by CGDRecord::parse_raw.
+  // curdir is the directory containing the .cgd file that the record was read from.
+  void add(CGDRecord const& record, std::string const& curdir);
+
+  // Write all records added so far to 'filename'.
+  // @throws std::runtime_error
+  void write(std::string const& filename) const;
+
+private:
+  uint32_t string_index(std::string const& str);
+};
+
+// Decodes the records of a .cgdb file that was read into memory.
+class CGDBinaryReader {
+private:
+  CGDFile const& M_cgd_file;
+  CGDBinaryHeader const* M_header;
+  uint32_t const* M_offsets;
+  CGDBinaryRecord const* M_records;
+  char const* M_strings;
+  // Anonymous namespaces are rewritten at most once per string.
+  std::vector<std::string> M_functions;
+  std::vector<bool> M_function_done;
+
+public:
+  // Check the header and the size of [begin, begin + size), the contents of cgd_file.
+  // @throws std::runtime_error
+  CGDBinaryReader(char const* begin, size_t size, CGDFile const& cgd_file);
+
+  // The number of records.
+  size_t size(void) const { return M_header->number_of_records; }
+
+  // Decode record number index into record, the same as CGDRecord::parse would have done for the text record.
+  // If raw is true, anonymous namespaces are not rewritten, as CGDRecord::parse_raw would have done.
+  // @throws std::runtime_error
+  void get(size_t index, CGDRecord& record, bool raw = false);
+
+private:
+  std::string const& function(uint32_t index);
+  void assign(std::string& str, uint32_t index) const
+      { str.assign(M_strings + M_offsets[index], M_offsets[index + 1] - M_offsets[index]); }
+};
+
+#endif // CGDBINARY_H
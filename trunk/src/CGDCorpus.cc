@@ -0,0 +1,351 @@
+// cppgraph -- C++ call graph analyzer
+//
+//! @file CGDCorpus.cc
+//! @brief This file contains the implementation of class CGDCorpus.
+//
+// Copyright (C) 2006, by Timmy <timmy1992@gmail.com>
+//
+// This file may be distributed under the terms of the Q Public License
+// version 1.0 as appearing in the file LICENSE.QPL included in the
+// packaging of this file.
+
+#include "sys.h"
+#include <cerrno>
+#include <cstring>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include "CGDCorpus.h"
+#include "CGDRecord.h"
+#include "MappedFile.h"
+#include "collapsedpath.h"
+#include "exceptions.h"
+#include "debug.h"
+
+namespace {
+
+// Return true if record is the definition of a function in a source file; the same test as FileName does.
+bool is_source_definition(CGDRecord const& record)
+{
+  if (record.type != 'F' || record.file[0] != '/')
+    return false;
+  std::string file(collapsedpath(record.file));
+  std::string::size_type pos = file.rfind('.');
+  if (pos == std::string::npos)
+    return false;
+  std::string extension(file, pos);
+  return extension == ".cc" || extension == ".cxx" || extension == ".cpp" || extension == ".C" || extension == ".c";
+}
+
+// Return true if record contains an anonymous namespace.
+bool is_anonymous(CGDRecord const& record)
+{
+  return record.function.find("<unnamed>::") != std::string::npos ||
+      (record.type == 'C' && record.callee.find("<unnamed>::") != std::string::npos);
+}
+
+// Return record as a line of a .cgd file.
+std::string format(CGDRecord const& record)
+{
+  std::ostringstream line;
+  line << record.type << " {" << record.function << "} {" << record.file << ':' << record.line_nr << '}';
+  if (record.type == 'C')
+    line << " {" << record.callee << "} {" << record.callee_file << '}';
+  return line.str();
+}
+
+// Return the next line of [begin, end), without the newline, and advance begin to the line after it.
+std::string next_line(char const*& begin, char const* end)
+{
+  char const* eol = static_cast<char const*>(memchr(begin, '\n', end - begin));
+  if (!eol)
+    eol = end;
+  std::string line(begin, eol);
+  begin = eol + 1;
+  return line;
+}
+
+void throw_error(std::string const& filename, int line_nr, char const* what)
+{
+  std::ostringstream ss;
+  ss << filename << ':' << line_nr << ": " << what;
+  THROW_EXCEPTION(std::runtime_error(ss.str()), "CGDCorpus: " << ss.str());
+}
+
+// Parse the unit numbers of a "#section" or "#also" line, that start at 'pos'.
+void parse_units(std::string const& line, std::string::size_type pos, size_t number_of_units,
+    std::string const& filename, int line_nr, std::vector<uint32_t>& units)
+{
+  units.clear();
+  char const* ptr = line.c_str() + pos;
+  for(;;)
+  {
+    char* number_end;
+    unsigned long unit = strtoul(ptr, &number_end, 10);
+    if (number_end == ptr)
+      break;
+    if (unit >= number_of_units)
+      throw_error(filename, line_nr, "unit out of range.");
+    units.push_back(unit);
+    ptr = number_end;
+  }
+  if (*ptr || units.empty())
+    throw_error(filename, line_nr, "syntax error.");
+}
+
+// Read the header of a corpus from [begin, end) into units, and advance begin to the first line after it.
+// Returns the number of lines read.
+int read_header(std::string const& filename, char const*& begin, char const* end, std::vector<std::string>& units)
+{
+  if (begin >= end || next_line(begin, end) != "#cgdm 1")
+    THROW_EXCEPTION(std::runtime_error(filename + ": not a .cgdm file, or an unsupported version."),
+	"read_header(\"" << filename << "\"): bad first line");
+  int line_nr = 1;
+  while (begin < end && end - begin > 7 && strncmp(begin, "#unit /", 7) == 0)
+  {
+    units.push_back(next_line(begin, end).substr(6));
+    ++line_nr;
+  }
+  return line_nr;
+}
+
+} // namespace
+
+void CGDCorpus::read_units(std::string const& filename, std::vector<std::string>& units)
+{
+  MappedFile input(filename);
+  char const* begin = input.begin();
+  read_header(filename, begin, input.end(), units);
+}
+
+CGDCorpus::record_type CGDCorpus::record_index(std::string const& line)
+{
+  std::pair<std::map<std::string, record_type>::iterator, bool> result =
+      M_record_index.insert(std::pair<std::string, record_type>(line, M_records.size()));
+  if (result.second)
+  {
+    M_records.push_back(&result.first->first);
+    M_record_units.push_back(std::vector<uint32_t>());
+  }
+  return result.first->second;
+}
+
+void CGDCorpus::add_unit(record_type record, size_t unit)
+{
+  std::vector<uint32_t>& units(M_record_units[record]);
+  std::vector<uint32_t>::iterator iter = std::lower_bound(units.begin(), units.end(), unit);
+  if (iter == units.end() || *iter != unit)
+    units.insert(iter, unit);
+}
+
+CGDCorpus::record_type CGDCorpus::add_record(size_t unit, CGDRecord const& record)
+{
+  record_type index = record_index(format(record));
+  if (is_anonymous(record))
+  {
+    // Only keep the first of identical records of the same unit.
+    std::vector<record_type>& anonymous(M_units[unit].anonymous);
+    if (std::find(anonymous.begin(), anonymous.end(), index) == anonymous.end())
+      anonymous.push_back(index);
+  }
+  else
+    add_unit(index, unit);
+  if (is_source_definition(record))
+    M_units[unit].source = index;
+  return index;
+}
+
+void CGDCorpus::clear(size_t unit)
+{
+  for (std::vector<std::vector<uint32_t> >::iterator units = M_record_units.begin(); units != M_record_units.end(); ++units)
+  {
+    std::vector<uint32_t>::iterator iter = std::lower_bound(units->begin(), units->end(), unit);
+    if (iter != units->end() && *iter == unit)
+      units->erase(iter);
+  }
+  M_units[unit].anonymous.clear();
+  M_units[unit].source = S_none;
+}
+
+void CGDCorpus::read(std::string const& filename)
+{
+  MappedFile input(filename);
+  char const* begin = input.begin();
+  char const* const end = input.end();
+  std::vector<std::string> units;
+  int line_nr = read_header(filename, begin, end, units);
+  size_t const first_unit = M_units.size();
+  for (std::vector<std::string>::iterator iter = units.begin(); iter != units.end(); ++iter)
+  {
+    if (!M_unit_index.insert(std::pair<std::string, size_t>(*iter, M_units.size())).second)
+      THROW_EXCEPTION(std::runtime_error(filename + ": " + *iter + " is listed twice."), "CGDCorpus::read: duplicate unit");
+    M_units.push_back(Unit(*iter));
+  }
+
+  size_t section = units.size();		// The current section; none yet.
+  record_type last = S_none;			// The last record, if it can be followed by "#also".
+  std::vector<uint32_t> numbers;
+  CGDRecord record;
+  while (begin < end)
+  {
+    std::string line(next_line(begin, end));
+    ++line_nr;
+    if (line.compare(0, 9, "#section ") == 0)
+    {
+      parse_units(line, 9, units.size(), filename, line_nr, numbers);
+      if (numbers.size() != 1)
+	throw_error(filename, line_nr, "syntax error.");
+      section = numbers[0];
+      last = S_none;
+    }
+    else if (line.compare(0, 6, "#also ") == 0)
+    {
+      if (last == S_none)
+	throw_error(filename, line_nr, "\"#also\" does not follow a record.");
+      parse_units(line, 6, units.size(), filename, line_nr, numbers);
+      for (std::vector<uint32_t>::iterator unit = numbers.begin(); unit != numbers.end(); ++unit)
+	add_unit(last, first_unit + *unit);
+      last = S_none;
+    }
+    else
+    {
+      if (section == units.size())
+	throw_error(filename, line_nr, "record before the first \"#section\".");
+      record.parse_raw(line.data(), line.size(), filename, line_nr);
+      record_type index = add_record(first_unit + section, record);
+      last = is_anonymous(record) ? S_none : index;
+    }
+  }
+}
+
+void CGDCorpus::add(std::string const& cgd_file, char const* begin, char const* end)
+{
+  std::pair<std::map<std::string, size_t>::iterator, bool> result =
+      M_unit_index.insert(std::pair<std::string, size_t>(cgd_file, M_units.size()));
+  size_t unit = result.first->second;
+  if (result.second)
+    M_units.push_back(Unit(cgd_file));
+  else
+    clear(unit);
+  // Relative paths in the .cgd file are relative to the directory that contains it.
+  std::string curdir(cgd_file, 0, cgd_file.rfind('/'));
+  CGDRecord record;
+  int line_nr = 0;
+  while (begin < end)
+  {
+    std::string line(next_line(begin, end));
+    record.parse_raw(line.data(), line.size(), cgd_file, ++line_nr);
+    CGDRecord::make_absolute(record.file, curdir);
+    if (record.type == 'C')
+      CGDRecord::make_absolute(record.callee_file, curdir);
+    add_record(unit, record);
+  }
+}
+
+bool CGDCorpus::remove(std::string const& cgd_file)
+{
+  std::map<std::string, size_t>::iterator iter = M_unit_index.find(cgd_file);
+  if (iter == M_unit_index.end())
+    return false;
+  clear(iter->second);
+  M_units[iter->second].cgd_file.clear();	// Marks the unit as removed.
+  M_unit_index.erase(iter);
+  return true;
+}
+
+size_t CGDCorpus::units(void) const
+{
+  return M_unit_index.size();
+}
+
+size_t CGDCorpus::records(void) const
+{
+  size_t count = 0;
+  for (std::vector<std::vector<uint32_t> >::const_iterator units = M_record_units.begin(); units != M_record_units.end(); ++units)
+    if (!units->empty())
+      ++count;
+  for (std::vector<Unit>::const_iterator unit = M_units.begin(); unit != M_units.end(); ++unit)
+    count += unit->anonymous.size();
+  return count;
+}
+
+void CGDCorpus::write(std::string const& filename) const
+{
+  // The units that were not removed get consecutive numbers.
+  std::vector<uint32_t> number(M_units.size());
+  uint32_t count = 0;
+  for (size_t unit = 0; unit < M_units.size(); ++unit)
+    if (!M_units[unit].cgd_file.empty())
+      number[unit] = count++;
+  // The records without an anonymous namespace are written in the section of their last unit.
+  std::vector<std::vector<record_type> > sections(M_units.size());
+  for (record_type record = 0; record < M_record_units.size(); ++record)
+    if (!M_record_units[record].empty())
+      sections[M_record_units[record].back()].push_back(record);
+
+  // Write to a temporary file first, so that genfull never sees a partial corpus.
+  std::string tmpname(filename + ".tmp");
+  std::ofstream out(tmpname.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+  if (out)
+  {
+    out << "#cgdm 1\n";
+    for (std::vector<Unit>::const_iterator unit = M_units.begin(); unit != M_units.end(); ++unit)
+      if (!unit->cgd_file.empty())
+	out << "#unit " << unit->cgd_file << '\n';
+    for (size_t unit = 0; unit < M_units.size(); ++unit)
+    {
+      if (M_units[unit].cgd_file.empty())
+	continue;
+      out << "#section " << number[unit] << '\n';
+      record_type const source = M_units[unit].source;
+      for (std::vector<record_type>::const_iterator record = M_units[unit].anonymous.begin();
+	  record != M_units[unit].anonymous.end(); ++record)
+	if (*record != source)
+	  out << *M_records[*record] << '\n';
+      for (std::vector<record_type>::const_iterator record = sections[unit].begin(); record != sections[unit].end(); ++record)
+      {
+	if (*record == source)
+	  continue;
+	out << *M_records[*record] << '\n';
+	std::vector<uint32_t> const& units(M_record_units[*record]);
+	if (units.size() > 1)
+	{
+	  out << "#also";
+	  for (std::vector<uint32_t>::const_iterator other = units.begin(); other != units.end() - 1; ++other)
+	    out << ' ' << number[*other];
+	  out << '\n';
+	}
+      }
+      if (source != S_none)
+      {
+	out << *M_records[source] << '\n';
+	// Only the section of the last unit of a record lists the other units.
+	std::vector<uint32_t> const& units(M_record_units[source]);
+	if (units.size() > 1 && units.back() == unit)
+	{
+	  out << "#also";
+	  for (std::vector<uint32_t>::const_iterator other = units.begin(); other != units.end() - 1; ++other)
+	    out << ' ' << number[*other];
+	  out << '\n';
+	}
+      }
+    }
+    out.close();
+  }
+  if (!out)
+  {
+    int saved_errno = errno;
+    std::remove(tmpname.c_str());
+    THROW_EXCEPTION(std::runtime_error(tmpname + ": " + strerror(saved_errno)),
+	"CGDCorpus::write(\"" << filename << "\"): writing failed");
+  }
+  if (std::rename(tmpname.c_str(), filename.c_str()) == -1)
+  {
+    int saved_errno = errno;
+    std::remove(tmpname.c_str());
+    THROW_EXCEPTION(std::runtime_error("rename: " + filename + ": " + strerror(saved_errno)),
+	"CGDCorpus::write(\"" << filename << "\"): rename failed");
+  }
+}
@@ -0,0 +1,99 @@
+// cppgraph -- C++ call graph analyzer
+//
+//! @file CGDCorpus.h
+//! @brief This file contains the declaration of class CGDCorpus.
+//
+// Copyright (C) 2006, by Timmy <timmy1992@gmail.com>
+//
+// This file may be distributed under the terms of the Q Public License
+// version 1.0 as appearing in the file LICENSE.QPL included in the
+// packaging of this file.
+
+#ifndef CGDCORPUS_H
+#define CGDCORPUS_H
+
+#include <string>
+#include <vector>
+#include <map>
+#include <stdint.h>
+
+class CGDRecord;
+
+// A corpus, a .cgdm file written by cgd-merge, contains the records of many
+// compilation units (.cgd files), but every distinct record only once:
+//
+//   #cgdm 1
+//   #unit <the .cgd file of compilation unit 0>
+//   #unit <the .cgd file of compilation unit 1>
+//   ...
+//   #section 0
+//   <records of unit 0>
+//   #section 1
+//   ...
+//
+// The records are .cgd records with absolute paths. genfull applies the sections
+// in order, each to the CGDFile of its compilation unit, which gives the same
+// result as reading the .cgd files of the units in that order:
+//
+// - A record with an anonymous namespace is stored in the section of every unit
+//   that contains it (genfull makes it unique per unit).
+// - Any other record is stored in the section of the last unit that contains it,
+//   so that the definition of a function is remembered in the same unit. It is
+//   followed by "#also <unit>..." with the other units that contain it.
+// - The last record of a section is the last definition in a source file of that
+//   unit (it determines CGDFile::source_file), even if it is stored elsewhere too.
+//
+// The "#also" lines are only used by cgd-merge, to update a corpus when some of
+// its units were compiled again.
+class CGDCorpus {
+private:
+  typedef uint32_t record_type;			// Index into M_records.
+  static record_type const S_none = static_cast<record_type>(-1);
+
+  struct Unit {
+    std::string cgd_file;			// The full path of the .cgd file.
+    std::vector<record_type> anonymous;		// The records with an anonymous namespace.
+    record_type source;				// The last definition in a source file, or S_none.
+    Unit(std::string const& f) : cgd_file(f), source(S_none) { }
+  };
+
+  std::vector<Unit> M_units;			// In the order that they were first added.
+  std::map<std::string, size_t> M_unit_index;	// The index of each unit in M_units.
+  std::map<std::string, record_type> M_record_index;
+  std::vector<std::string const*> M_records;	// Points to the keys of M_record_index.
+  std::vector<std::vector<uint32_t> > M_record_units;	// The units (sorted) that contain each record without an anonymous namespace.
+
+public:
+  // Read the existing corpus 'filename'.
+  // @throws std::runtime_error
+  void read(std::string const& filename);
+
+  // Add the .cgd file cgd_file, [begin, end), as compilation unit; if it is already
+  // part of the corpus then its old records are replaced. cgd_file must be a full
+  // path without symbolic links, like genfull finds it.
+  // @throws std::runtime_error
+  void add(std::string const& cgd_file, char const* begin, char const* end);
+
+  // Remove the compilation unit cgd_file. Returns false if it isn't part of the corpus.
+  bool remove(std::string const& cgd_file);
+
+  // Write the corpus to 'filename'.
+  // @throws std::runtime_error
+  void write(std::string const& filename) const;
+
+  // The number of compilation units, and the number of records that will be written.
+  size_t units(void) const;
+  size_t records(void) const;
+
+  // Read only the list of compilation units of corpus 'filename'.
+  // @throws std::runtime_error
+  static void read_units(std::string const& filename, std::vector<std::string>& units);
+
+private:
+  record_type record_index(std::string const& line);
+  void add_unit(record_type record, size_t unit);
+  record_type add_record(size_t unit, CGDRecord const& record);
+  void clear(size_t unit);
+};
+
+#endif // CGDCORPUS_H
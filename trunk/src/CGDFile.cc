@@ -13,56 +13,378 @@
 #include <sys/types.h>
 #include <dirent.h>
 #include <cerrno>
+#include <cstring>
 #include <sys/stat.h>
+#include <fcntl.h>
 #include <unistd.h>
+#include <pthread.h>
+#include <deque>
+#include <set>
+#include <map>
+#include <vector>
+#include <algorithm>
+#include <cmath>
 #include "CGDFile.h"
+#include "CGDCorpus.h"
 #include "Subdir.h"
+#include "content_hash.h"
 #include "exceptions.h"
 #include "debug.h"
 
-static void process_directory(std::string const& path, bool recursive)
+namespace {
+
+// The result of scanning a single directory.
+//
+// The entries are stored in the order that readdir returned them, so that
+// CGDFile::container can be filled in exactly the same (depth-first) order
+// as when the directories would be processed recursively by a single thread.
+struct DirectoryScan {
+  struct Entry {
+    std::string cgd_file;		// The full path of a .cgd file, if subdir is NULL.
+    DirectoryScan* subdir;		// A subdirectory, or NULL.
+    Entry(std::string const& path) : cgd_file(path), subdir(NULL) { }
+    Entry(DirectoryScan* scan) : subdir(scan) { }
+  };
+
+  std::string path;
+  bool recursive;
+  std::vector<Entry> entries;
+  std::string error;			// Set when scanning failed after reading 'entries'.
+
+  DirectoryScan(std::string const& p, bool r) : path(p), recursive(r) { }
+  ~DirectoryScan()
+  {
+    for (std::vector<Entry>::iterator iter = entries.begin(); iter != entries.end(); ++iter)
+      delete iter->subdir;
+  }
+};
+
+// Work queue of directories that still need to be scanned.
+struct Crawler {
+  pthread_mutex_t mutex;
+  pthread_cond_t cond;
+  std::deque<DirectoryScan*> queue;
+  size_t pending;			// Number of directories queued or being scanned.
+};
+
+// The length of the suffix of each format.
+size_t const suffix_length[] = { 0, 4, 5, 7, 8, 5 };
+
+// The same compilation unit can be present in more than one format, for example
+// when a .cgdb file was converted from the .cgd file next to it (see cgd2bin).
+// Only use the most recently modified one; if they are equally old, prefer the
+// format that is cheapest to read.
+void remove_duplicate_cgd_files(DirectoryScan* scan, int fd, std::set<std::string> const& duplicate_stems)
+{
+  int const cost[] = { 0, 1, 0, 3, 2, 0 };	// Indexed by cgd_format_type.
+  std::map<std::string, std::pair<std::string, struct stat> > best;	// Stem -> (name, stat).
+  for (std::vector<DirectoryScan::Entry>::iterator iter = scan->entries.begin(); iter != scan->entries.end(); ++iter)
+  {
+    if (iter->subdir)
+      continue;
+    cgd_format_type format = cgd_format(iter->cgd_file.c_str());
+    if (format == cgd_format_corpus)
+      continue;
+    std::string stem(iter->cgd_file, 0, iter->cgd_file.size() - suffix_length[format]);
+    if (duplicate_stems.find(stem) == duplicate_stems.end())
+      continue;
+    std::string name(iter->cgd_file, iter->cgd_file.rfind('/') + 1);
+    struct stat statbuf;
+    if (fstatat(fd, name.c_str(), &statbuf, 0) == -1)
+      continue;
+    std::map<std::string, std::pair<std::string, struct stat> >::iterator best_iter = best.find(stem);
+    if (best_iter == best.end())
+    {
+      best[stem] = std::make_pair(iter->cgd_file, statbuf);
+      continue;
+    }
+    struct stat const& best_stat(best_iter->second.second);
+    if (statbuf.st_mtime > best_stat.st_mtime ||
+        (statbuf.st_mtime == best_stat.st_mtime && cost[format] < cost[cgd_format(best_iter->second.first.c_str())]))
+      best_iter->second = std::make_pair(iter->cgd_file, statbuf);
+  }
+  std::vector<DirectoryScan::Entry> entries;
+  for (std::vector<DirectoryScan::Entry>::iterator iter = scan->entries.begin(); iter != scan->entries.end(); ++iter)
+  {
+    if (!iter->subdir && cgd_format(iter->cgd_file.c_str()) != cgd_format_corpus)
+    {
+      std::string stem(iter->cgd_file, 0, iter->cgd_file.size() - suffix_length[cgd_format(iter->cgd_file.c_str())]);
+      std::map<std::string, std::pair<std::string, struct stat> >::iterator best_iter = best.find(stem);
+      if (best_iter != best.end() && best_iter->second.first != iter->cgd_file)
+      {
+	Dout(dc::subdirs, "Ignoring: " << iter->cgd_file);
+	continue;
+      }
+    }
+    entries.push_back(*iter);
+  }
+  scan->entries.swap(entries);
+}
+
+// Read the directory scan->path and add its entries to scan.
+// Subdirectories that need to be scanned too are added to 'subdirs'.
+void scan_directory(DirectoryScan* scan, std::vector<DirectoryScan*>& subdirs)
 {
+  std::string const& path(scan->path);
+  bool recursive = scan->recursive;
   Dout(dc::subdirs, path << (recursive ? " (recursive)" : " (not recursive)"));
-  DebugIndent(2);
-  DIR* dir = opendir(path.c_str());
+  int fd = open(path.c_str(), O_RDONLY | O_DIRECTORY);
+  DIR* dir = (fd == -1) ? NULL : fdopendir(fd);
   if (!dir)
-    THROW_EXCEPTION(std::runtime_error(path + ": " + strerror(errno)),
-	"process_directory(\"" << path << "\", " << (recursive ? "true" : "false") << "): opendir failed");
+  {
+    scan->error = path + ": " + strerror(errno);
+    if (fd != -1)
+      close(fd);
+    return;
+  }
+  std::set<std::string> stems;
+  std::set<std::string> duplicate_stems;
   struct dirent* dirent;
+  errno = 0;
   while ((dirent = readdir(dir)))
   {
-    struct stat statbuf;
-    std::string direntname = path + "/" + dirent->d_name;
-    if (stat(direntname.c_str(), &statbuf) == -1)
-      THROW_EXCEPTION(std::runtime_error("stat: " + direntname + ": " + strerror(errno)),
-	  "process_directory(\"" << path << "\", " << (recursive ? "true" : "false") << "): stat failed");
-    if (S_ISREG(statbuf.st_mode))
+    char const* name = dirent->d_name;
+    cgd_format_type format = cgd_format(name);
+    bool is_cgd = format != cgd_format_none;
+    bool maybe_subdir = recursive && name[0] != '.';
+    if (!is_cgd && !maybe_subdir)
+      continue;				// Not interested in this entry, whatever type it is.
+    unsigned char type = dirent->d_type;
+    // Only call stat when the file system didn't tell us the type, or when we need to follow a symbolic link.
+    if (type == DT_UNKNOWN || type == DT_LNK)
     {
-      size_t len = strlen(dirent->d_name);
-      if (len >= 4 && !strcmp(dirent->d_name + len - 4, ".cgd"))
+      struct stat statbuf;
+      if (fstatat(fd, name, &statbuf, 0) == -1)
       {
-	Dout(dc::subdirs, "Found: " << direntname);
-	CGDFile cgd_file(direntname);
-	cgd_file.add(CGDFile::container, cgd_file);
-	CGDFile::container_type::iterator cgd_iter = cgd_file.get_iter();
-	CGDFile::init_short_name(cgd_iter);
+	scan->error = "stat: " + path + "/" + name + ": " + strerror(errno);
+	break;
       }
+      type = S_ISREG(statbuf.st_mode) ? DT_REG : S_ISDIR(statbuf.st_mode) ? DT_DIR : DT_UNKNOWN;
+    }
+    if (type == DT_REG && is_cgd)
+    {
+      Dout(dc::subdirs, "Found: " << path << '/' << name);
+      scan->entries.push_back(DirectoryScan::Entry(path + "/" + name));
+      std::string stem(scan->entries.back().cgd_file, 0, scan->entries.back().cgd_file.size() - suffix_length[format]);
+      // A corpus is not a compilation unit itself.
+      if (format != cgd_format_corpus && !stems.insert(stem).second)
+	duplicate_stems.insert(stem);
+    }
+    else if (type == DT_DIR && maybe_subdir)
+    {
+      DirectoryScan* subdir = new DirectoryScan(path + "/" + name, true);
+      scan->entries.push_back(DirectoryScan::Entry(subdir));
+      subdirs.push_back(subdir);
+    }
+    errno = 0;
+  }
+  if (!dirent && errno == EBADF)
+    scan->error = std::string("readdir: ") + strerror(errno);
+  if (!duplicate_stems.empty())
+    remove_duplicate_cgd_files(scan, fd, duplicate_stems);
+  closedir(dir);			// Also closes fd.
+}
+
+void* crawler_worker(void* arg)
+{
+  Debug(debug::init_thread());
+  Crawler& crawler(*static_cast<Crawler*>(arg));
+  std::vector<DirectoryScan*> subdirs;
+  pthread_mutex_lock(&crawler.mutex);
+  for(;;)
+  {
+    while (crawler.queue.empty() && crawler.pending > 0)
+      pthread_cond_wait(&crawler.cond, &crawler.mutex);
+    if (crawler.queue.empty())
+      break;				// pending == 0: we're done.
+    DirectoryScan* scan = crawler.queue.front();
+    crawler.queue.pop_front();
+    pthread_mutex_unlock(&crawler.mutex);
+    subdirs.clear();
+    scan_directory(scan, subdirs);
+    pthread_mutex_lock(&crawler.mutex);
+    crawler.queue.insert(crawler.queue.end(), subdirs.begin(), subdirs.end());
+    crawler.pending += subdirs.size();
+    --crawler.pending;
+    pthread_cond_broadcast(&crawler.cond);
+  }
+  pthread_mutex_unlock(&crawler.mutex);
+  return NULL;
+}
+
+// The compilation units of the corpora that were found.
+struct Corpora {
+  std::map<std::string, std::vector<std::string> > units;	// Corpus -> the .cgd files of its units.
+  std::map<std::string, std::string> stems;			// The stem of every unit -> its corpus.
+};
+
+// Return filename without the suffix of its format.
+std::string stem_of(std::string const& filename)
+{
+  return std::string(filename, 0, filename.size() - suffix_length[cgd_format(filename.c_str())]);
+}
+
+// Read the list of units of the corpora found in scan, and recursively in its subdirectories.
+void find_corpora(DirectoryScan const* scan, Corpora& corpora)
+{
+  for (std::vector<DirectoryScan::Entry>::const_iterator iter = scan->entries.begin(); iter != scan->entries.end(); ++iter)
+  {
+    if (iter->subdir)
+    {
+      find_corpora(iter->subdir, corpora);
+      continue;
+    }
+    if (cgd_format(iter->cgd_file.c_str()) != cgd_format_corpus)
+      continue;
+    std::vector<std::string>& units(corpora.units[iter->cgd_file]);
+    CGDCorpus::read_units(iter->cgd_file, units);
+    for (std::vector<std::string>::iterator unit = units.begin(); unit != units.end(); ++unit)
+    {
+      std::pair<std::map<std::string, std::string>::iterator, bool> result =
+	  corpora.stems.insert(std::pair<std::string, std::string>(stem_of(*unit), iter->cgd_file));
+      if (!result.second)
+	THROW_EXCEPTION(std::runtime_error(*unit + " is part of both " + result.first->second + " and " + iter->cgd_file + "."),
+	    "find_corpora(): " << *unit << " is part of more than one corpus");
     }
-    else if (recursive && dirent->d_name[0] != '.' && S_ISDIR(statbuf.st_mode))
-      process_directory(direntname, true);
   }
-  if (errno == EBADF)
-    THROW_EXCEPTION(std::runtime_error(std::string("readdir: ") + strerror(errno)),
-	"process_directory(\"" << path << "\", " << (recursive ? "true" : "false") << "): readdir(" << dir << ") failed");
-  closedir(dir);
 }
 
-void initialize_cgd_files(void)
+// Append the input files found in scan, and recursively in its subdirectories, to input_files.
+// Input files of the compilation units of a corpus are ignored.
+void collect_input_files(DirectoryScan const* scan, Corpora const& corpora, std::vector<std::string>& input_files)
+{
+  for (std::vector<DirectoryScan::Entry>::const_iterator iter = scan->entries.begin(); iter != scan->entries.end(); ++iter)
+  {
+    if (iter->subdir)
+    {
+      collect_input_files(iter->subdir, corpora, input_files);
+      continue;
+    }
+    if (cgd_format(iter->cgd_file.c_str()) != cgd_format_corpus && corpora.stems.find(stem_of(iter->cgd_file)) != corpora.stems.end())
+    {
+      Dout(dc::subdirs, "Ignoring: " << iter->cgd_file);
+      continue;
+    }
+    input_files.push_back(iter->cgd_file);
+  }
+  if (!scan->error.empty())
+    THROW_EXCEPTION(std::runtime_error(scan->error),
+	"collect_input_files(): scanning \"" << scan->path << "\" (" << (scan->recursive ? "recursive" : "not recursive") <<
+	") failed");
+}
+
+// Keep only the input files that are selected by sample, in the same order.
+//
+// Every input file gets a key that only depends on its name and the seed, and the files with the
+// lowest keys are selected. Hence the same files are selected every time, regardless of the order
+// in which they were found, and a larger sample contains every file of a smaller one.
+void select_sample(std::vector<std::string>& input_files, CGDSample const& sample)
+{
+  size_t size = sample.size < 1 ? static_cast<size_t>(std::ceil(sample.size * input_files.size())) : static_cast<size_t>(sample.size);
+  if (size >= input_files.size())
+    return;
+  std::vector<std::pair<uint64_t, size_t> > keys;	// (key, index into input_files).
+  for (size_t index = 0; index < input_files.size(); ++index)
+    keys.push_back(std::pair<uint64_t, size_t>(content_hash(input_files[index].data(), input_files[index].size(), sample.seed), index));
+  std::nth_element(keys.begin(), keys.begin() + size, keys.end());
+  std::vector<size_t> selected;
+  for (size_t i = 0; i < size; ++i)
+    selected.push_back(keys[i].second);
+  std::sort(selected.begin(), selected.end());
+  std::vector<std::string> result;
+  for (std::vector<size_t>::iterator index = selected.begin(); index != selected.end(); ++index)
+    result.push_back(input_files[*index]);
+  input_files.swap(result);
+}
+
+} // namespace
+
+cgd_format_type cgd_format(char const* filename)
+{
+  size_t len = strlen(filename);
+  for (int format = cgd_format_text; format <= cgd_format_corpus; ++format)
+  {
+    static char const* const suffix[] = { NULL, ".cgd", ".cgdb", ".cgd.gz", ".cgd.zst", ".cgdm" };
+    if (len >= suffix_length[format] && !strcmp(filename + len - suffix_length[format], suffix[format]))
+      return static_cast<cgd_format_type>(format);
+  }
+  return cgd_format_none;
+}
+
+CGDFile::container_type::iterator add_cgd_file(std::string const& filename)
 {
+  CGDFile cgd_file(filename);
+  cgd_file.add(CGDFile::container, cgd_file);
+  CGDFile::container_type::iterator cgd_iter = cgd_file.get_iter();
+  CGDFile::init_short_name(cgd_iter);
+  return cgd_iter;
+}
+
+void get_input_files(std::vector<CGDFile::container_type::iterator>& input_files)
+{
+  for (CGDFile::container_type::iterator iter = CGDFile::container.begin(); iter != CGDFile::container.end(); ++iter)
+    if (iter->corpus_index() == 0)
+      input_files.push_back(iter);
+}
+
+void initialize_cgd_files(int jobs, CGDSample& sample)
+{
+  std::vector<DirectoryScan*> roots;
+  Crawler crawler;
+  pthread_mutex_init(&crawler.mutex, NULL);
+  pthread_cond_init(&crawler.cond, NULL);
   for (SubdirSet::iterator iter = subdirs.begin(); iter != subdirs.end(); ++iter)
-    process_directory(iter->realpath(), iter->is_recursive());
+  {
+    roots.push_back(new DirectoryScan(iter->realpath(), iter->is_recursive()));
+    crawler.queue.push_back(roots.back());
+  }
+  crawler.pending = crawler.queue.size();
+  if (jobs <= 1)
+    crawler_worker(&crawler);
+  else
+  {
+    std::vector<pthread_t> threads(jobs);
+    for (int i = 0; i < jobs; ++i)
+      if (pthread_create(&threads[i], NULL, crawler_worker, &crawler) != 0)
+	DoutFatal(dc::fatal|error_cf, "pthread_create");
+    for (int i = 0; i < jobs; ++i)
+      pthread_join(threads[i], NULL);
+  }
+  pthread_cond_destroy(&crawler.cond);
+  pthread_mutex_destroy(&crawler.mutex);
+  try
+  {
+    Corpora corpora;
+    for (std::vector<DirectoryScan*>::iterator iter = roots.begin(); iter != roots.end(); ++iter)
+      find_corpora(*iter, corpora);
+    std::vector<std::string> input_files;
+    for (std::vector<DirectoryScan*>::iterator iter = roots.begin(); iter != roots.end(); ++iter)
+      collect_input_files(*iter, corpora, input_files);
+    // A corpus is replaced by its compilation units.
+    sample.found = input_files.size();
+    for (std::map<std::string, std::vector<std::string> >::iterator corpus = corpora.units.begin(); corpus != corpora.units.end(); ++corpus)
+      sample.found += corpus->second.size() - 1;
+    if (sample.enabled())
+      select_sample(input_files, sample);
+    for (std::vector<std::string>::iterator iter = input_files.begin(); iter != input_files.end(); ++iter)
+    {
+      std::map<std::string, std::vector<std::string> >::const_iterator corpus = corpora.units.find(*iter);
+      if (corpus == corpora.units.end())
+	add_cgd_file(*iter);
+      else
+	for (size_t index = 0; index < corpus->second.size(); ++index)
+	  add_cgd_file(corpus->second[index])->set_corpus(corpus->first, index);
+    }
+  }
+  catch (std::runtime_error const&)
+  {
+    for (std::vector<DirectoryScan*>::iterator iter = roots.begin(); iter != roots.end(); ++iter)
+      delete *iter;
+    throw;
+  }
+  for (std::vector<DirectoryScan*>::iterator iter = roots.begin(); iter != roots.end(); ++iter)
+    delete *iter;
   if (CGDFile::container.empty())
     THROW_EXCEPTION(no_cgd_files(), "initialize_cgd_files(): No \".cgd\" input files found");
   CGDFile::generate_short_names();
 }
-
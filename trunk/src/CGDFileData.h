@@ -13,29 +13,61 @@
 #define CGDFILEDATA_H
 
 #include <string>
+#include <cstring>
 #include "ElementBase.h"
 #include "LongName.h"
+#include "Symbol.h"
 #include "serialization.h"
 
 template<class Container, class FileName>
 class CGDFileData : public ElementBase<Container>, public LongName<Container> {
 public:
   CGDFileData(std::string const& filename) :
-      LongName<Container>(filename), M_source_file(FileName::container.end()) { }
+      LongName<Container>(filename), M_unit_name(unit_name(filename)),
+      M_directory(std::string(filename, 0, filename.rfind('/'))),
+      M_source_file(FileName::container.end()), M_corpus_index(0) { }
 
 public:
   // Used by LongName
   static char const* seperator(void) { return "/"; }
   bool process(void) const { return true; }
+  // The short name is the same for every format of a compilation unit; it is
+  // used to make anonymous namespaces unique, see CGDRecord::rewrite_unnamed.
+  std::string const& short_name_source(void) const { return M_unit_name.str(); }
 
 public:
+  // The directory containing the input file; relative paths in the file are relative to it.
+  Symbol directory(void) const { return M_directory; }
   bool has_source_file(void) const { return M_source_file != FileName::container.end(); }
   FileName const& source_file(void) const { return *M_source_file; }
+  // The corpus (see CGDCorpus.h) that contains the records of this compilation unit, if any,
+  // and the number of the unit in it.
+  bool in_corpus(void) const { return !M_corpus.empty(); }
+  std::string const& corpus(void) const { return M_corpus; }
+  size_t corpus_index(void) const { return M_corpus_index; }
+  // The file that has to be read to get the records of this input file.
+  std::string const& input_file(void) const { return in_corpus() ? M_corpus : this->long_name(); }
 
 protected:
+  Symbol M_unit_name;			// The long name, with the suffix of a binary or compressed format replaced by ".cgd".
+  Symbol M_directory;
   typename FileName::container_type::iterator M_source_file;
+  std::string M_corpus;
+  size_t M_corpus_index;
 
 private:
+  static std::string unit_name(std::string const& filename)
+  {
+    static char const* const suffixes[] = { ".cgdb", ".cgd.gz", ".cgd.zst" };
+    for (size_t i = 0; i < sizeof(suffixes) / sizeof(suffixes[0]); ++i)
+    {
+      std::string::size_type len = std::strlen(suffixes[i]);
+      if (filename.size() > len && filename.compare(filename.size() - len, len, suffixes[i]) == 0)
+	return filename.substr(0, filename.size() - len) + ".cgd";
+    }
+    return filename;
+  }
+
   // Serialization.
   friend class boost::serialization::access;
   template<class Archive>
@@ -0,0 +1,237 @@
+// cppgraph -- C++ call graph analyzer
+//
+//! @file CGDRecord.cc
+//! @brief This file contains the implementation of class CGDRecord.
+//
+// Copyright (C) 2006, by Timmy <timmy1992@gmail.com>
+//
+// This file may be distributed under the terms of the Q Public License
+// version 1.0 as appearing in the file LICENSE.QPL included in the
+// packaging of this file.
+
+#include "sys.h"
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <stdint.h>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+#ifdef HAVE_TARGET_AVX2
+#include <immintrin.h>
+#endif
+#include "CGDRecord.h"
+#include "exceptions.h"
+#include "debug.h"
+
+void CGDRecord::rewrite_unnamed(std::string& function_str, CGDFile const& cgd_file, std::string& buffer)
+{
+  std::string::size_type pos = function_str.find("<unnamed>::");
+  if (pos == std::string::npos)
+    return;
+  // Copy function_str into buffer once, inserting "@<short name>" after every "<unnamed".
+  buffer.clear();
+  std::string::size_type done = 0;
+  do
+  {
+    pos += 8;
+    buffer.append(function_str, done, pos - done);
+    buffer += '@';
+    buffer += cgd_file.short_name();
+    done = pos;
+    pos = function_str.find("<unnamed>::", pos);
+  }
+  while (pos != std::string::npos);
+  buffer.append(function_str, done, std::string::npos);
+  function_str.swap(buffer);
+}
+
+namespace {
+
+// A tokenizer stores the positions of the first 'count' '}' characters of [line, line + len)
+// in 'ends', and returns how many it found.
+//
+// Those are the ends of the fields of a record: parse_raw checks that every field starts
+// with " {", so the first '}' after the start of a field is also the first '}' after the
+// end of the previous field.
+typedef int (*tokenizer_function)(char const* line, size_t len, char const** ends, int count);
+
+int find_braces_scalar(char const* line, size_t len, char const** ends, int count)
+{
+  int found = 0;
+  char const* const end = line + len;
+  for (char const* ptr = line; ptr != end; ++ptr)
+    if (*ptr == '}')
+    {
+      ends[found] = ptr;
+      if (++found == count)
+	break;
+    }
+  return found;
+}
+
+#if defined(__SSE2__)
+int find_braces_sse2(char const* line, size_t len, char const** ends, int count)
+{
+  int found = 0;
+  char const* ptr = line;
+  char const* const end = line + len;
+  __m128i const brace = _mm_set1_epi8('}');
+  for (; end - ptr >= 16; ptr += 16)
+  {
+    unsigned int mask = _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128(reinterpret_cast<__m128i const*>(ptr)), brace));
+    for (; mask; mask &= mask - 1)
+    {
+      ends[found] = ptr + __builtin_ctz(mask);
+      if (++found == count)
+	return found;
+    }
+  }
+  return found + find_braces_scalar(ptr, end - ptr, ends + found, count - found);
+}
+#endif
+
+#ifdef HAVE_TARGET_AVX2
+__attribute__((target("avx2")))
+int find_braces_avx2(char const* line, size_t len, char const** ends, int count)
+{
+  int found = 0;
+  char const* ptr = line;
+  char const* const end = line + len;
+  __m256i const brace = _mm256_set1_epi8('}');
+  for (; end - ptr >= 32; ptr += 32)
+  {
+    unsigned int mask = _mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_loadu_si256(reinterpret_cast<__m256i const*>(ptr)), brace));
+    for (; mask; mask &= mask - 1)
+    {
+      ends[found] = ptr + __builtin_ctz(mask);
+      if (++found == count)
+      {
+	_mm256_zeroupper();
+	return found;
+      }
+    }
+  }
+  // Not every compiler does this itself; without it, the following (non-VEX) SSE2 code is very slow.
+  _mm256_zeroupper();
+  return found + find_braces_sse2(ptr, end - ptr, ends + found, count - found);
+}
+#endif
+
+tokenizer_function const tokenizers[] = {
+  find_braces_scalar,
+#if defined(__SSE2__)
+  find_braces_sse2,
+#else
+  NULL,
+#endif
+#ifdef HAVE_TARGET_AVX2
+  find_braces_avx2
+#else
+  NULL
+#endif
+};
+
+CGDRecord::tokenizer_type best_tokenizer(void)
+{
+#ifdef HAVE_TARGET_AVX2
+  __builtin_cpu_init();		// Needed, because this is called before main().
+  if (__builtin_cpu_supports("avx2"))
+    return CGDRecord::tokenizer_avx2;
+#endif
+#if defined(__SSE2__)
+  return CGDRecord::tokenizer_sse2;
+#else
+  return CGDRecord::tokenizer_scalar;
+#endif
+}
+
+CGDRecord::tokenizer_type S_tokenizer = best_tokenizer();
+tokenizer_function S_find_braces = tokenizers[S_tokenizer];
+
+} // namespace
+
+bool CGDRecord::set_tokenizer(tokenizer_type tokenizer)
+{
+  if (!tokenizers[tokenizer] || (tokenizer == tokenizer_avx2 && best_tokenizer() != tokenizer_avx2))
+    return false;
+  S_tokenizer = tokenizer;
+  S_find_braces = tokenizers[tokenizer];
+  return true;
+}
+
+CGDRecord::tokenizer_type CGDRecord::tokenizer(void)
+{
+  return S_tokenizer;
+}
+
+char const* CGDRecord::tokenizer_name(tokenizer_type tokenizer)
+{
+  static char const* const names[] = { "scalar", "sse2", "avx2" };
+  return names[tokenizer];
+}
+
+void CGDRecord::parse_raw(char const* line, size_t len, std::string const& filename, int input_line_nr)
+{
+  if (len == 0 || (line[0] != 'F' && line[0] != 'C'))
+  {
+    std::ostringstream ss;
+    ss << filename << ':' << input_line_nr << ": syntax error: Lines are expected to start with either F or C.";
+    THROW_EXCEPTION(std::runtime_error(ss.str()),
+	"CGDRecord::parse_raw(\"" << std::string(line, len) << "\", \"" << filename <<
+	"\", " << input_line_nr << "): Input doesn't start with F or C");
+  }
+  type = line[0];
+  bool parse_error = false;
+  char const* const end = line + len;
+  char const* ptr = line;
+  int const number_of_fields = type == 'F' ? 2 : 4;
+  char const* field_ends[4];
+  int found = S_find_braces(line, len, field_ends, number_of_fields);
+  for (int field = 0; field < number_of_fields; ++field)
+  {
+    if (end - ptr < 3 || ptr[1] != ' ' || ptr[2] != '{' || field == found)
+    {
+      parse_error = true;
+      break;
+    }
+    int n = field_ends[field] - ptr;
+    if (field == 0)
+    {
+      function.assign(ptr + 3, n - 3);
+    }
+    else if (field == 1)
+    {
+      char const* colon = static_cast<char const*>(memchr(ptr + 3, ':', n - 3));
+      if (!colon)
+      {
+        parse_error = true;
+	break;
+      }
+      line_nr = atoi(colon + 1);
+      if (line_nr == 0)
+      {
+        parse_error = true;
+	break;
+      }
+      file.assign(ptr + 3, colon - (ptr + 3));
+    }
+    else if (field == 2)
+    {
+      callee.assign(ptr + 3, n - 3);
+    }
+    else if (field == 3)
+    {
+      callee_file.assign(ptr + 3, n - 3);
+    }
+    ptr += n;
+  }
+  if (parse_error)
+  {
+    std::ostringstream ss;
+    ss << filename << ':' << input_line_nr << ": Parse error.";
+    THROW_EXCEPTION(std::runtime_error(ss.str()),
+	"CGDRecord::parse_raw(\"" << std::string(line, len) << "\", \"" << filename <<
+	"\", " << input_line_nr << "): Parse error");
+  }
+}
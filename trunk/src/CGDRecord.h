@@ -0,0 +1,123 @@
+// cppgraph -- C++ call graph analyzer
+//
+//! @file CGDRecord.h
+//! @brief This file contains the declaration of class CGDRecord.
+//
+// Copyright (C) 2006, by Timmy <timmy1992@gmail.com>
+//
+// This file may be distributed under the terms of the Q Public License
+// version 1.0 as appearing in the file LICENSE.QPL included in the
+// packaging of this file.
+
+#ifndef CGDRECORD_H
+#define CGDRECORD_H
+
+#include <string>
+#include <stdint.h>
+#include "CGDFile.h"
+#include "Functions.h"
+
+// A single line of a .cgd file, either
+//
+//   F {function} {file:line}
+//
+// for the definition of a function, or
+//
+//   C {caller} {file:line} {callee} {file}
+//
+// for a call.
+//
+// Parsing a line does not touch any of the global containers and can therefore
+// be done by any thread.  Applying the record to the global containers can not.
+struct CGDRecord {
+  // The implementations of the tokenizer of parse_raw, that finds the end of every field.
+  enum tokenizer_type { tokenizer_scalar, tokenizer_sse2, tokenizer_avx2 };
+
+  char type;			// Either 'F' or 'C'.
+  std::string function;		// The defined function, or the caller.
+  std::string file;		// The file of the definition or call location, relative to the directory of the input file.
+  int line_nr;			// The line number of the definition or call location.
+  std::string callee;		// The called function (only when type == 'C').
+  std::string callee_file;	// The file in which the callee is declared (only when type == 'C'), relative like file.
+
+  // Parse the line [line, line + len) of cgd_file; input_line_nr is only used for error reporting.
+  void parse(char const* line, size_t len, CGDFile const& cgd_file, int input_line_nr)
+  {
+    parse_raw(line, len, cgd_file.long_name(), input_line_nr);
+    resolve_functions(cgd_file);
+  }
+
+  // Split the line [line, line + len) of input file 'filename' into its fields, as they appear in the file.
+  // filename and input_line_nr are only used for error reporting.
+  void parse_raw(char const* line, size_t len, std::string const& filename, int input_line_nr);
+
+  // Let parse_raw use 'tokenizer'. By default, the fastest tokenizer that the CPU supports is used.
+  // Returns false when the tokenizer is not supported. Only call this while no other thread is parsing.
+  static bool set_tokenizer(tokenizer_type tokenizer);
+  static tokenizer_type tokenizer(void);
+  static char const* tokenizer_name(tokenizer_type tokenizer);
+
+  // Make the functions returned by parse_raw unique for cgd_file: append the name of the cgd file
+  // to anonymous namespaces. Relative paths are left alone; apply resolves them.
+  void resolve_functions(CGDFile const& cgd_file)
+  {
+    std::string buffer;
+    resolve_functions(cgd_file, buffer);
+  }
+
+  // The same, using buffer as scratch space; reusing it avoids memory allocations.
+  void resolve_functions(CGDFile const& cgd_file, std::string& buffer)
+  {
+    rewrite_unnamed(function, cgd_file, buffer);
+    if (type == 'C')
+      rewrite_unnamed(callee, cgd_file, buffer);
+  }
+
+  // The number of a function that was applied; only valid until finish_ingestion is called.
+  typedef uint32_t function_id;
+
+  // Add the filenames, location, functions and edge of this record to their containers.
+  // Relative paths are relative to the directory of cgd_file. Returns the defined function, or the caller.
+  // Only the FileNames are added right away: the rest is collected until finish_ingestion is called.
+  function_id apply(CGDFile::container_type::iterator cgd_file) const;
+
+  // Make cgd_file the input file that contains the definition of 'function', like apply does for an 'F' record.
+  static void set_definition(function_id function, CGDFile::container_type::iterator cgd_file);
+
+  // Add everything that was applied to Function::container, Edge::container (with the call sites) and Location::container,
+  // sorting with up to 'jobs' threads. Must be called after the last record was applied.
+  static void finish_ingestion(int jobs);
+
+  // Statistics of the cache that apply uses to find the FileName of a path: the
+  // number of paths looked up, and how many of those were found in the cache.
+  static size_t file_lookups(void);
+  static size_t file_lookup_hits(void);
+
+  // Statistics of the cache that apply uses to recognize calls that it applied before: the
+  // number of calls looked up, and how many of those were found (and not applied again).
+  static size_t call_lookups(void);
+  static size_t call_lookup_hits(void);
+
+  // Append the short name of the CGD file to each anonymous namespace in function, because
+  // those are unique per compilation unit. It doesn't depend on the format of the file.
+  static void rewrite_unnamed(std::string& function, CGDFile const& cgd_file)
+  {
+    std::string buffer;
+    rewrite_unnamed(function, cgd_file, buffer);
+  }
+
+  // The same, using buffer as scratch space; reusing it avoids memory allocations.
+  static void rewrite_unnamed(std::string& function, CGDFile const& cgd_file, std::string& buffer);
+
+  // Return true if file is a relative path (and not something like "<built-in>").
+  static bool is_relative(std::string const& file) { return !file.empty() && file[0] != '/' && file[0] != '<'; }
+
+  // Prepend curdir to file, if that is a relative path.
+  static void make_absolute(std::string& file, std::string const& curdir)
+  {
+    if (is_relative(file))
+      file = curdir + "/" + file;
+  }
+};
+
+#endif // CGDRECORD_H
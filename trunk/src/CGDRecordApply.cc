@@ -0,0 +1,319 @@
+// cppgraph -- C++ call graph analyzer
+//
+//! @file CGDRecordApply.cc
+//! @brief This file contains the implementation of CGDRecord::apply and CGDRecord::finish_ingestion.
+//
+// Copyright (C) 2006, by Timmy <timmy1992@gmail.com>
+//
+// This file may be distributed under the terms of the Q Public License
+// version 1.0 as appearing in the file LICENSE.QPL included in the
+// packaging of this file.
+
+#include "sys.h"
+#include <cstddef>
+#include <map>
+#include <vector>
+#include <algorithm>
+#include <functional>
+#include <stdint.h>
+#include "CGDRecord.h"
+#include "FileName.h"
+#include "Location.h"
+#include "Function.h"
+#include "Edge.h"
+#include "content_hash.h"
+#include "HashIndex.h"
+#include "parallel_sort.h"
+#include "debug.h"
+
+namespace {
+
+// Finds the FileName of a path as it appears in an input file.
+//
+// The same few thousand headers are seen millions of times; this makes sure
+// that every path is only made absolute and collapsed the first time.
+class FileNameCache {
+private:
+  SymbolIndex<FileName> M_absolute;		// Indexed by the path.
+  typedef std::pair<Symbol::id_type, Symbol::id_type> key_type;	// The directory and the path.
+  std::map<key_type, FileName const*> M_relative;
+  size_t M_lookups;
+  size_t M_hits;
+
+public:
+  FileNameCache(void) : M_lookups(0), M_hits(0) { }
+
+  FileName const& find(std::string const& path, CGDFile const& cgd_file);
+  size_t lookups(void) const { return M_lookups; }
+  size_t hits(void) const { return M_hits; }
+};
+
+FileName const& FileNameCache::find(std::string const& path, CGDFile const& cgd_file)
+{
+  ++M_lookups;
+  Symbol raw(path);
+  if (!CGDRecord::is_relative(path))
+  {
+    FileName const* known = M_absolute.find(raw);
+    if (known)
+    {
+      ++M_hits;
+      return *known;
+    }
+    FileName const file_name(path);
+    M_absolute.insert(raw, *file_name.get_iter());
+    return *file_name.get_iter();
+  }
+  std::pair<std::map<key_type, FileName const*>::iterator, bool> result =
+      M_relative.insert(std::pair<key_type, FileName const*>(key_type(cgd_file.directory().id(), raw.id()), NULL));
+  if (!result.second)
+  {
+    ++M_hits;
+    return *result.first->second;
+  }
+  FileName const file_name(cgd_file.directory().str() + "/" + path);
+  result.first->second = &*file_name.get_iter();
+  return *file_name.get_iter();
+}
+
+FileNameCache file_names;
+
+// A function, as it is identified while reading the input files: by its name and the FileName
+// of its declaration (or definition), exactly the keys of a Function.
+struct FunctionKey {
+  FileName const* file;
+  Symbol::id_type name;
+  FunctionKey(void) : file(NULL), name(0) { }
+  FunctionKey(Symbol n, FileName const& f) : file(&f), name(n.id()) { }
+  uint64_t hash(void) const { return content_hash(reinterpret_cast<char const*>(&file), sizeof(file), name); }
+  friend bool operator==(FunctionKey const& key1, FunctionKey const& key2)
+      { return key1.file == key2.file && key1.name == key2.name; }
+};
+
+// A call, as it appears in a record: the caller and the FileName and line of the call location,
+// and the callee and the FileName of its declaration.
+struct CallKey {
+  FunctionKey caller;
+  FunctionKey callee;
+  int line_nr;
+  CallKey(void) : line_nr(0) { }
+  CallKey(FunctionKey const& c1, int l, FunctionKey const& c2) : caller(c1), callee(c2), line_nr(l) { }
+  uint64_t hash(void) const { return (caller.hash() + line_nr) ^ (callee.hash() * 0x9e3779b97f4a7c15ULL); }
+  friend bool operator==(CallKey const& key1, CallKey const& key2)
+      { return key1.caller == key2.caller && key1.callee == key2.callee && key1.line_nr == key2.line_nr; }
+};
+
+// Collects the functions, calls and locations of the records that are applied, and
+// adds them to Function::container, Edge::container (with the call sites of every
+// edge) and Location::container when all input files were read.
+//
+// Inserting every record into those sets right away costs a tree insert, with string
+// comparisons, per record. Instead, the functions are numbered in the order in which
+// they are first seen, and the edges and locations are appended to flat buffers. At
+// the end, the buffers are sorted in the order of the containers, so that every
+// element is inserted at the end of its set, without comparing strings.
+//
+// The same call in a header is seen again in every compilation unit that includes
+// that header; such a call is recognized here before anything is looked up.
+class Staging {
+private:
+  struct StagedFunction {
+    Symbol name;
+    FileName const* file;
+    CGDFile::container_type::const_iterator cgd_file;	// The input file of the last definition.
+    bool definition;
+  };
+
+  // Orders the numbers of staged functions like Function::container orders the functions.
+  struct FunctionOrder {
+    std::vector<StagedFunction> const* M_functions;
+    bool operator()(CGDRecord::function_id id1, CGDRecord::function_id id2) const
+    {
+      StagedFunction const& function1((*M_functions)[id1]);
+      StagedFunction const& function2((*M_functions)[id2]);
+      return function1.name < function2.name ||
+          (function1.name == function2.name && function1.file != function2.file && *function1.file < *function2.file);
+    }
+  };
+
+  struct StagedCall {
+    CGDRecord::function_id caller;
+    CGDRecord::function_id callee;
+    Location call_site;
+  };
+
+  std::vector<StagedFunction> M_functions;		// Indexed by function_id.
+  HashIndex<FunctionKey> M_function_index;
+  HashIndex<CallKey> M_call_index;			// The value is the caller.
+  std::vector<StagedCall> M_calls;			// Without duplicates.
+  Location::container_type M_locations;			// With duplicates, see add_location.
+  size_t M_unique_locations;				// The size of M_locations after removing the duplicates.
+  size_t M_call_lookups;
+  size_t M_call_hits;
+
+public:
+  Staging(void) : M_unique_locations(0), M_call_lookups(0), M_call_hits(0) { }
+
+  // Return the number of the function 'name' declared in 'file'.
+  CGDRecord::function_id add_function(Symbol name, FileName const& file);
+  // Remember that the function was defined in cgd_file (the last such call wins).
+  void set_definition(CGDRecord::function_id function, CGDFile::container_type::const_iterator cgd_file)
+      { M_functions[function].definition = true; M_functions[function].cgd_file = cgd_file; }
+  // Return the number of the caller of the call from 'function' at line_nr of 'file' to 'callee' declared in 'callee_file'.
+  CGDRecord::function_id add_call(Symbol function, FileName const& file, int line_nr, Symbol callee, FileName const& callee_file);
+  void add_location(FileName const& file, int line_nr);
+
+  // Add everything to the global containers, and forget it.
+  void finish(int jobs);
+
+  size_t call_lookups(void) const { return M_call_lookups; }
+  size_t call_hits(void) const { return M_call_hits; }
+};
+
+CGDRecord::function_id Staging::add_function(Symbol name, FileName const& file)
+{
+  FunctionKey const key(name, file);
+  CGDRecord::function_id function = M_function_index.find(key);
+  if (function == HashIndex<FunctionKey>::none)
+  {
+    function = M_functions.size();
+    StagedFunction const staged = { name, &file, CGDFile::container.end(), false };
+    M_functions.push_back(staged);
+    M_function_index.insert(key, function);
+  }
+  return function;
+}
+
+CGDRecord::function_id Staging::add_call(Symbol function, FileName const& file, int line_nr, Symbol callee, FileName const& callee_file)
+{
+  ++M_call_lookups;
+  CallKey const key(FunctionKey(function, file), line_nr, FunctionKey(callee, callee_file));
+  CGDRecord::function_id caller = M_call_index.find(key);
+  if (caller != HashIndex<CallKey>::none)
+  {
+    ++M_call_hits;
+    return caller;
+  }
+  caller = add_function(function, file);
+  StagedCall const call = { caller, add_function(callee, callee_file), Location(file, line_nr) };
+  M_calls.push_back(call);
+  M_call_index.insert(key, caller);
+  return caller;
+}
+
+void Staging::add_location(FileName const& file, int line_nr)
+{
+  M_locations.push_back(Location(file, line_nr));
+  // Nearly all locations are seen many times; remove the duplicates every now and then.
+  if (M_locations.size() >= 2 * M_unique_locations + 65536)
+  {
+    std::sort(M_locations.begin(), M_locations.end());
+    M_locations.erase(std::unique(M_locations.begin(), M_locations.end()), M_locations.end());
+    M_unique_locations = M_locations.size();
+  }
+}
+
+void Staging::finish(int jobs)
+{
+  // The functions, in the order of Function::container.
+  std::vector<CGDRecord::function_id> order(M_functions.size());
+  for (size_t index = 0; index < order.size(); ++index)
+    order[index] = index;
+  FunctionOrder const function_order = { &M_functions };
+  parallel_sort(order.begin(), order.end(), function_order, jobs);
+  std::vector<Functions::iterator> functions(order.size());	// Indexed by the position in order.
+  std::vector<uint32_t> position(order.size());			// Indexed by function_id.
+  for (size_t index = 0; index < order.size(); ++index)
+  {
+    StagedFunction const& staged(M_functions[order[index]]);
+    Function const function(staged.name, *staged.file, Function::container.end());
+    if (staged.definition)
+      const_cast<Function&>(*function.get_iter()).set_definition(staged.cgd_file);
+    functions[index] = function.get_iter();
+    position[order[index]] = index;
+  }
+  std::vector<CGDRecord::function_id>().swap(order);
+
+  // The calls, in the order of Edge::container (by caller, then by callee) and then by call site.
+  // The first element is the position of the caller in the upper half, and of the callee in the lower half.
+  std::vector<std::pair<uint64_t, Location> > calls;
+  calls.reserve(M_calls.size());
+  for (std::vector<StagedCall>::iterator iter = M_calls.begin(); iter != M_calls.end(); ++iter)
+    calls.push_back(std::make_pair(static_cast<uint64_t>(position[iter->caller]) << 32 | position[iter->callee], iter->call_site));
+  std::vector<StagedCall>().swap(M_calls);
+  parallel_sort(calls.begin(), calls.end(), std::less<std::pair<uint64_t, Location> >(), jobs);
+  for (size_t index = 0; index < calls.size();)
+  {
+    uint64_t const pair = calls[index].first;
+    size_t end = index + 1;
+    while (end < calls.size() && calls[end].first == pair)
+      ++end;
+    Edges::iterator edge = const_cast<Function&>(*functions[pair >> 32]).add_callee(*functions[pair & 0xffffffff], Edge::container.end());
+    Location::container_type& call_sites(const_cast<Edge&>(*edge).call_sites());
+    call_sites.reserve(end - index);
+    for (; index < end; ++index)
+      call_sites.push_back(calls[index].second);
+  }
+
+  Location::add(M_locations, jobs);
+
+  // Free the memory, the function numbers are no longer valid.
+  std::vector<StagedFunction>().swap(M_functions);
+  M_function_index.clear();
+  M_call_index.clear();
+  M_unique_locations = 0;
+}
+
+Staging staging;
+
+} // namespace
+
+size_t CGDRecord::file_lookups(void)
+{
+  return file_names.lookups();
+}
+
+size_t CGDRecord::file_lookup_hits(void)
+{
+  return file_names.hits();
+}
+
+size_t CGDRecord::call_lookups(void)
+{
+  return staging.call_lookups();
+}
+
+size_t CGDRecord::call_lookup_hits(void)
+{
+  return staging.call_hits();
+}
+
+void CGDRecord::set_definition(function_id function, CGDFile::container_type::iterator cgd_file)
+{
+  staging.set_definition(function, cgd_file);
+}
+
+void CGDRecord::finish_ingestion(int jobs)
+{
+  staging.finish(jobs);
+}
+
+CGDRecord::function_id CGDRecord::apply(CGDFile::container_type::iterator cgd_file) const
+{
+  FileName const& file_name(file_names.find(file, *cgd_file));
+  staging.add_location(file_name, line_nr);
+  if (type == 'F')	// Declarion and not call location?
+  {
+    if (file_name.is_source_file())
+      const_cast<CGDFile&>(*cgd_file).set_source_file(file_name);
+    // Add new function declaration.
+    function_id const function_definition = staging.add_function(Symbol(function), file_name);
+    staging.set_definition(function_definition, cgd_file);
+    return function_definition;
+  }
+  else
+  {
+    FileName const& callee_file_name(file_names.find(callee_file, *cgd_file));
+    return staging.add_call(Symbol(function), file_name, line_nr, Symbol(callee), callee_file_name);
+  }
+}
@@ -0,0 +1,67 @@
+// cppgraph -- C++ call graph analyzer
+//
+//! @file CallGraph.cc
+//! @brief This file contains the implementation of class CallGraph.
+//
+// Copyright (C) 2006, by Timmy <timmy1992@gmail.com>
+//
+// This file may be distributed under the terms of the Q Public License
+// version 1.0 as appearing in the file LICENSE.QPL included in the
+// packaging of this file.
+
+#include "sys.h"
+#include <algorithm>
+#include "CallGraph.h"
+#include "debug.h"
+
+CallGraph call_graph;
+
+void CallGraph::freeze(void)
+{
+  size_t const functions = Function::id_count();
+  size_t const edges = Edge::container.size();
+  // Count the callees and callers of every function, and turn the counts into offsets.
+  M_callees_offset.assign(functions + 1, 0);
+  M_callers_offset.assign(functions + 1, 0);
+  for (Edges::iterator edge = Edge::container.begin(); edge != Edge::container.end(); ++edge)
+  {
+    ++M_callees_offset[edge->get_caller().id() + 1];
+    ++M_callers_offset[edge->get_callee().id() + 1];
+  }
+  for (size_t id = 0; id < functions; ++id)
+  {
+    M_callees_offset[id + 1] += M_callees_offset[id];
+    M_callers_offset[id + 1] += M_callers_offset[id];
+  }
+  // Fill the rows. Edge::container is ordered by caller and then by callee, and we run over
+  // it in that order, so both the callees and the callers end up in the order of Function::container.
+  M_callees.resize(edges);
+  M_out_edges.resize(edges);
+  M_callers.resize(edges);
+  M_in_edges.resize(edges);
+  std::vector<uint32_t> next_callee(M_callees_offset.begin(), M_callees_offset.end() - 1);
+  std::vector<uint32_t> next_caller(M_callers_offset.begin(), M_callers_offset.end() - 1);
+  for (Edges::iterator edge = Edge::container.begin(); edge != Edge::container.end(); ++edge)
+  {
+    id_type const caller = edge->get_caller().id();
+    id_type const callee = edge->get_callee().id();
+    uint32_t const out = next_callee[caller]++;
+    M_callees[out] = callee;
+    M_out_edges[out] = edge->id();
+    uint32_t const in = next_caller[callee]++;
+    M_callers[in] = caller;
+    M_in_edges[in] = edge->id();
+  }
+  Dout(dc::notice, "Froze the call graph: " << functions << " function ids and " << edges << " edges.");
+}
+
+void CallGraph::get_call_sites(Function const& callee, std::vector<Location>& call_sites) const
+{
+  call_sites.clear();
+  for (const_iterator edge = in_edges_begin(callee.id()); edge != in_edges_end(callee.id()); ++edge)
+  {
+    Location::container_type const& edge_call_sites(Edge::by_id(*edge)->call_sites());
+    call_sites.insert(call_sites.end(), edge_call_sites.begin(), edge_call_sites.end());
+  }
+  std::sort(call_sites.begin(), call_sites.end());
+}
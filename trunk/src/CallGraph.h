@@ -0,0 +1,62 @@
+// cppgraph -- C++ call graph analyzer
+//
+//! @file CallGraph.h
+//! @brief This file contains the declaration of class CallGraph.
+//
+// Copyright (C) 2006, by Timmy <timmy1992@gmail.com>
+//
+// This file may be distributed under the terms of the Q Public License
+// version 1.0 as appearing in the file LICENSE.QPL included in the
+// packaging of this file.
+
+#ifndef CALLGRAPH_H
+#define CALLGRAPH_H
+
+#include <vector>
+#include <stdint.h>
+#include "Function.h"
+#include "Edge.h"
+
+// The edges of Edge::container in compressed sparse row form, indexed by function id:
+// for every function the ids of its callees (forward) and of its callers (reverse),
+// with, in parallel, the ids of the edges. The callees and callers of a function are
+// in the order of Function::container, so that walking the functions in the order of
+// their container and then over their callees visits the edges in the order of
+// Edge::container.
+//
+// The graph is built once by freeze, after which no function or edge may be added or erased.
+class CallGraph {
+public:
+  typedef Function::id_type id_type;
+  typedef std::vector<id_type>::const_iterator const_iterator;
+
+  // Build the arrays from Edge::container.
+  void freeze(void);
+
+  // The ids of the functions called by 'caller', and of the corresponding edges.
+  const_iterator callees_begin(id_type caller) const { return M_callees.begin() + M_callees_offset[caller]; }
+  const_iterator callees_end(id_type caller) const { return M_callees.begin() + M_callees_offset[caller + 1]; }
+  const_iterator out_edges_begin(id_type caller) const { return M_out_edges.begin() + M_callees_offset[caller]; }
+  const_iterator out_edges_end(id_type caller) const { return M_out_edges.begin() + M_callees_offset[caller + 1]; }
+
+  // The ids of the functions that call 'callee', and of the corresponding edges.
+  const_iterator callers_begin(id_type callee) const { return M_callers.begin() + M_callers_offset[callee]; }
+  const_iterator callers_end(id_type callee) const { return M_callers.begin() + M_callers_offset[callee + 1]; }
+  const_iterator in_edges_begin(id_type callee) const { return M_in_edges.begin() + M_callers_offset[callee]; }
+  const_iterator in_edges_end(id_type callee) const { return M_in_edges.begin() + M_callers_offset[callee + 1]; }
+
+  // Replace call_sites with the locations of all calls to 'callee', sorted.
+  void get_call_sites(Function const& callee, std::vector<Location>& call_sites) const;
+
+private:
+  std::vector<uint32_t> M_callees_offset;	// Indexed by function id; one more than there are ids.
+  std::vector<id_type> M_callees;
+  std::vector<Edge::id_type> M_out_edges;
+  std::vector<uint32_t> M_callers_offset;	// Likewise.
+  std::vector<id_type> M_callers;
+  std::vector<Edge::id_type> M_in_edges;
+};
+
+extern CallGraph call_graph;
+
+#endif // CALLGRAPH_H
@@ -12,18 +12,61 @@
 #include "sys.h"
 #include "Class.h"
 #include "Function.h"
+#include "content_hash.h"
+#include "HashIndex.h"
 #include "debug.h"
 
+namespace {
+
+// A scope, as it is looked up while analyzing the function declarations: a component
+// in the scope of a parent class or namespace.
+struct ScopeKey {
+  Class::id_type parent;		// 'none' for the global namespace.
+  Symbol::id_type component;
+  bool has_template_argument_list;
+  ScopeKey(void) : parent(0), component(0), has_template_argument_list(false) { }
+  ScopeKey(Class::id_type p, Symbol c, bool t) : parent(p), component(c.id()), has_template_argument_list(t) { }
+  uint64_t hash(void) const
+      { return content_hash(reinterpret_cast<char const*>(&component), sizeof(component), 2 * (uint64_t)parent + has_template_argument_list); }
+  friend bool operator==(ScopeKey const& key1, ScopeKey const& key2)
+      { return key1.parent == key2.parent && key1.component == key2.component &&
+               key1.has_template_argument_list == key2.has_template_argument_list; }
+};
+
+HashIndex<ScopeKey> scopes;		// The value is the id of the Class.
+
+} // namespace
+
+Classes::iterator Class::scope(Classes::iterator parent, Symbol component, bool has_template_argument_list)
+{
+  ScopeKey const key(parent == container.end() ? HashIndex<ScopeKey>::none : parent->id(), component, has_template_argument_list);
+  uint32_t const known = scopes.find(key);
+  if (known != HashIndex<ScopeKey>::none)
+    return by_id(known);
+  std::string name;
+  if (parent != container.end())
+  {
+    name = parent->base_name();
+    name += "::";
+  }
+  name += component.str();
+  if (has_template_argument_list)
+    name += "<>";
+  Class const a_class(name);
+  scopes.insert(key, a_class.id());
+  return a_class.get_iter();
+}
+
 void Class::set_parent(void)
 {
   // We can be called more than once, speed that up.
   if (M_parent != container.end())
     return;
-  std::string::size_type pos = M_KEY_base_name.rfind("::");
+  std::string::size_type pos = base_name().rfind("::");
   std::string parent_name;
   if (pos != std::string::npos)
-    parent_name.assign(M_KEY_base_name, 0, pos);
-  else if (M_KEY_base_name.empty())
+    parent_name.assign(base_name(), 0, pos);
+  else if (base_name().empty())
     return;
   Class parent(parent_name);
   M_parent = parent.get_iter();
@@ -31,8 +74,8 @@ void Class::set_parent(void)
 
 void Class::add_project(Project const& project)
 {
-  if (M_KEY_base_name.substr(0, 3) == "std" && project.short_name() != "4.0.2")
-    DoutFatal(dc::core, "Assigning " << project.short_name() << " to " << M_KEY_base_name);
+  if (base_name().substr(0, 3) == "std" && project.short_name() != "4.0.2")
+    DoutFatal(dc::core, "Assigning " << project.short_name() << " to " << base_name());
   Project::container_type::iterator project_iter = project.get_iter();
   M_projects.insert(std::pair<Project::container_type::iterator, int>(project_iter, 0)).first->second++;
 }
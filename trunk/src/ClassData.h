@@ -16,6 +16,7 @@
 #include <map>
 #include "Node.h"
 #include "ElementBase.h"
+#include "Symbol.h"
 #include "serialization.h"
 
 template<class Container, class Class, class Project>
@@ -24,7 +25,7 @@ public:
   ClassData(std::string const& base_name);
 
 public:
-  std::string const& base_name(void) const { return M_KEY_base_name; }
+  std::string const& base_name(void) const { return M_KEY_base_name.str(); }
   typename Container::iterator parent_iter(void) const { return M_parent; }
   Class const& get_parent(void) const { return *M_parent; }
   bool is_class(void) const { return M_is_class; }
@@ -37,13 +38,13 @@ public:
 
   // Used by Node:
 protected:
-  virtual std::string const& node_name(void) const { return M_KEY_base_name.empty() ? S_root_namespace : M_KEY_base_name; }
+  virtual std::string const& node_name(void) const { return base_name().empty() ? S_root_namespace : base_name(); }
   virtual NodeType node_type(void) const { return class_or_namespace_node; }
 private:
   static std::string const S_root_namespace;
 
 protected:
-  std::string M_KEY_base_name;			// For example, "std::_Rb_tree<>::_Rb_tree_impl<>",
+  Symbol M_KEY_base_name;			// For example, "std::_Rb_tree<>::_Rb_tree_impl<>",
   						// with stripped template argument list.
   bool M_is_class;				// Otherwise, it could be a namespace too, actually.
   typename Container::iterator M_parent;	// Parent class, or namespace.
@@ -58,7 +59,9 @@ private:
   void serialize(Archive& ar, unsigned int const UNUSED(version))
   {
     ar & BOOST_SERIALIZATION_BASE_OBJECT_NVP(Node);
-    ar & BOOST_SERIALIZATION_NVP(M_KEY_base_name);
+    std::string base_name(M_KEY_base_name.str());
+    ar & boost::serialization::make_nvp("M_KEY_base_name", base_name);
+    M_KEY_base_name = Symbol(base_name);
     ar & BOOST_SERIALIZATION_NVP(M_is_class);
     ar & SERIALIZATION_ITERATOR_NVP(this->container, M_parent);
     ar & BOOST_SERIALIZATION_NVP(M_is_functor);
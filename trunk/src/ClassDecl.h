@@ -12,25 +12,36 @@
 #ifndef CLASSDECL_H
 #define CLASSDECL_H
 
-#include <string>
 #include <cassert>
-#include "serialization.h"
+#include <stdint.h>
+
+// A part of the string that a declaration was parsed from: the 'length'
+// characters starting at 'offset'. Declarations are parsed from the names of
+// the functions, that never move, so they don't need copies of their parts.
+struct DeclSlice {
+  uint32_t offset;
+  uint32_t length;
+
+  DeclSlice(void) : offset(0), length(0) { }
+  DeclSlice(uint32_t offset_, uint32_t length_) : offset(offset_), length(length_) { }
+
+  bool empty(void) const { return length == 0; }
+};
 
 class ClassDecl {
 public:
   ClassDecl(void) : M_is_function(false), M_action_count(0) { }
-  ClassDecl(std::string const& name) : M_name(name), M_is_function(false), M_action_count(0) { }
-  ClassDecl(std::string const& name, std::string const& template_argument_list) :
-      M_name(name), M_template_argument_list_opt(template_argument_list), M_is_function(false), M_action_count(0) { }
+  ClassDecl(DeclSlice name) : M_name(name), M_is_function(false), M_action_count(0) { }
 
-  void set_template_argument_list(std::string const& template_argument_list)
+  void set_template_argument_list(DeclSlice template_argument_list)
       { assert(!has_template_argument_list()); M_template_argument_list_opt = template_argument_list; }
-  void set_name(std::string const& name)
-      { M_name = name; M_template_argument_list_opt.clear(); }
+  void set_name(DeclSlice name)
+      { M_name = name; M_template_argument_list_opt = DeclSlice(); }
   void set_is_function(void) { M_is_function = true; }
 
-  std::string const& name(void) const { return M_name; }  
-  std::string const& template_argument_list(void) const { return M_template_argument_list_opt; }
+  // The slices of the FunctionDecl that contains this ClassDecl.
+  DeclSlice name(void) const { return M_name; }
+  DeclSlice template_argument_list(void) const { return M_template_argument_list_opt; }
   bool has_template_argument_list(void) const { return !M_template_argument_list_opt.empty(); }
   bool is_function(void) const { return M_is_function; }
 
@@ -38,21 +49,10 @@ public:
   bool action_end(void) { return 0 == --M_action_count; }
 
 private:
-  std::string M_name;
-  std::string M_template_argument_list_opt;
+  DeclSlice M_name;
+  DeclSlice M_template_argument_list_opt;
   bool M_is_function;
   int M_action_count;		// Used by parser.
-
-private:
-  // Serialization.
-  friend class boost::serialization::access;
-  template<class Archive>
-  void serialize(Archive& ar, unsigned int const UNUSED(version))
-  {
-    ar & BOOST_SERIALIZATION_NVP(M_name);
-    ar & BOOST_SERIALIZATION_NVP(M_template_argument_list_opt);
-    ar & BOOST_SERIALIZATION_NVP(M_is_function);
-  }
 };
 
 #endif // CLASSDECL_H
@@ -0,0 +1,148 @@
+// cppgraph -- C++ call graph analyzer
+//
+//! @file Decompressor.cc
+//! @brief This file contains the implementation of the gzip and zstd decompressors.
+//
+// Copyright (C) 2006, by Timmy <timmy1992@gmail.com>
+//
+// This file may be distributed under the terms of the Q Public License
+// version 1.0 as appearing in the file LICENSE.QPL included in the
+// packaging of this file.
+
+#include "sys.h"
+#include <cstring>
+#include <algorithm>
+#include <stdexcept>
+#include "Decompressor.h"
+#if defined(HAVE_LIBZ) && defined(HAVE_ZLIB_H)
+#include <zlib.h>
+#endif
+#if defined(HAVE_LIBZSTD) && defined(HAVE_ZSTD_H)
+#include <zstd.h>
+#endif
+#include "exceptions.h"
+#include "debug.h"
+
+namespace {
+
+#if defined(HAVE_LIBZ) && defined(HAVE_ZLIB_H)
+class GzipDecompressor : public Decompressor {
+private:
+  std::string const& M_filename;
+  z_stream M_stream;
+  size_t M_remaining;			// Number of input bytes not yet passed to zlib.
+  bool M_end;
+
+public:
+  GzipDecompressor(char const* begin, size_t size, std::string const& filename);
+  ~GzipDecompressor() { inflateEnd(&M_stream); }
+  virtual size_t read(char* buf, size_t capacity);
+};
+
+GzipDecompressor::GzipDecompressor(char const* begin, size_t size, std::string const& filename) :
+    M_filename(filename), M_remaining(size), M_end(false)
+{
+  memset(&M_stream, 0, sizeof(M_stream));
+  M_stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(begin));
+  // Add 32 to the window size to detect the gzip header automatically.
+  if (inflateInit2(&M_stream, 15 + 32) != Z_OK)
+    THROW_EXCEPTION(std::runtime_error(M_filename + ": gzip: " + (M_stream.msg ? M_stream.msg : "inflateInit2 failed")),
+	"GzipDecompressor::GzipDecompressor(): inflateInit2 failed");
+}
+
+size_t GzipDecompressor::read(char* buf, size_t capacity)
+{
+  M_stream.next_out = reinterpret_cast<Bytef*>(buf);
+  M_stream.avail_out = capacity;
+  while (!M_end && M_stream.avail_out == capacity)
+  {
+    // zlib can only handle 4 GB at a time.
+    if (M_stream.avail_in == 0 && M_remaining > 0)
+    {
+      M_stream.avail_in = std::min(M_remaining, static_cast<size_t>(1) << 30);
+      M_remaining -= M_stream.avail_in;
+    }
+    int ret = inflate(&M_stream, Z_NO_FLUSH);
+    if (ret == Z_STREAM_END)
+    {
+      // A gzip file can consist of more than one member, for example when it was concatenated.
+      if (M_stream.avail_in > 0 || M_remaining > 0)
+	inflateReset(&M_stream);
+      else
+	M_end = true;
+    }
+    else if (ret == Z_BUF_ERROR && M_stream.avail_in == 0)
+      THROW_EXCEPTION(std::runtime_error(M_filename + ": gzip: unexpected end of file"),
+	  "GzipDecompressor::read(): truncated input");
+    else if (ret != Z_OK)
+      THROW_EXCEPTION(std::runtime_error(M_filename + ": gzip: " + (M_stream.msg ? M_stream.msg : "inflate failed")),
+	  "GzipDecompressor::read(): inflate returned " << ret);
+  }
+  return capacity - M_stream.avail_out;
+}
+#endif
+
+#if defined(HAVE_LIBZSTD) && defined(HAVE_ZSTD_H)
+class ZstdDecompressor : public Decompressor {
+private:
+  std::string const& M_filename;
+  ZSTD_DStream* M_stream;
+  ZSTD_inBuffer M_in;
+  size_t M_last_ret;			// The last return value of ZSTD_decompressStream; 0 when a frame was completed.
+
+public:
+  ZstdDecompressor(char const* begin, size_t size, std::string const& filename);
+  ~ZstdDecompressor() { ZSTD_freeDStream(M_stream); }
+  virtual size_t read(char* buf, size_t capacity);
+};
+
+ZstdDecompressor::ZstdDecompressor(char const* begin, size_t size, std::string const& filename) :
+    M_filename(filename), M_stream(ZSTD_createDStream()), M_last_ret(1)
+{
+  ZSTD_initDStream(M_stream);
+  M_in.src = begin;
+  M_in.size = size;
+  M_in.pos = 0;
+}
+
+size_t ZstdDecompressor::read(char* buf, size_t capacity)
+{
+  ZSTD_outBuffer out = { buf, capacity, 0 };
+  while (out.pos == 0)
+  {
+    if (M_in.pos == M_in.size && M_last_ret == 0)
+      break;				// All frames were completely decoded and flushed.
+    size_t in_pos = M_in.pos;
+    size_t ret = ZSTD_decompressStream(M_stream, &out, &M_in);
+    if (ZSTD_isError(ret))
+      THROW_EXCEPTION(std::runtime_error(M_filename + ": zstd: " + ZSTD_getErrorName(ret)),
+	  "ZstdDecompressor::read(): ZSTD_decompressStream failed");
+    M_last_ret = ret;
+    if (out.pos == 0 && M_in.pos == in_pos && M_in.pos == M_in.size)
+      THROW_EXCEPTION(std::runtime_error(M_filename + ": zstd: unexpected end of file"),
+	  "ZstdDecompressor::read(): truncated input");
+  }
+  return out.pos;
+}
+#endif
+
+} // namespace
+
+Decompressor* Decompressor::create(cgd_format_type format, char const* begin, size_t size, std::string const& filename)
+{
+  switch (format)
+  {
+#if defined(HAVE_LIBZ) && defined(HAVE_ZLIB_H)
+    case cgd_format_gzip:
+      return new GzipDecompressor(begin, size, filename);
+#endif
+#if defined(HAVE_LIBZSTD) && defined(HAVE_ZSTD_H)
+    case cgd_format_zstd:
+      return new ZstdDecompressor(begin, size, filename);
+#endif
+    default:
+      break;
+  }
+  THROW_EXCEPTION(std::runtime_error(filename + ": support for this compression format was not compiled in."),
+      "Decompressor::create(" << format << ", \"" << filename << "\"): unsupported format");
+}
@@ -0,0 +1,34 @@
+// cppgraph -- C++ call graph analyzer
+//
+//! @file Decompressor.h
+//! @brief This file contains the declaration of class Decompressor.
+//
+// Copyright (C) 2006, by Timmy <timmy1992@gmail.com>
+//
+// This file may be distributed under the terms of the Q Public License
+// version 1.0 as appearing in the file LICENSE.QPL included in the
+// packaging of this file.
+
+#ifndef DECOMPRESSOR_H
+#define DECOMPRESSOR_H
+
+#include <string>
+#include "CGDFile.h"
+
+// Decompresses a compressed input file, that was read into memory, one chunk at a time.
+class Decompressor {
+public:
+  virtual ~Decompressor() { }
+
+  // Decompress the next chunk into [buf, buf + capacity).
+  // Returns the number of bytes written, or 0 at the end of the input.
+  // @throws std::runtime_error
+  virtual size_t read(char* buf, size_t capacity) = 0;
+
+  // Create a decompressor for the compressed data [begin, begin + size) of 'filename',
+  // that is a file of format 'format' (cgd_format_gzip or cgd_format_zstd).
+  // @throws std::runtime_error when the format is not supported by this build.
+  static Decompressor* create(cgd_format_type format, char const* begin, size_t size, std::string const& filename);
+};
+
+#endif // DECOMPRESSOR_H
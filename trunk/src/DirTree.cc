@@ -34,7 +34,7 @@ void DirTree::erase(void)
   for (std::vector<DirTree::container_type::iterator>::const_iterator iter = M_path_rest.begin();
       iter != M_path_rest.end(); ++iter)
     const_cast<DirTree&>(**iter).erase();
-  DirTree::container.erase(M_iter);
+  remove(M_iter);
 }
 
 void initialize_dirtrees(
@@ -12,17 +12,18 @@
 #ifndef EDGEDATA_H
 #define EDGEDATA_H
 
+#include <vector>
 #include "ElementBase.h"
 #include "serialization.h"
 
-template<class Container, class Functions, class Function>
+template<class Container, class Functions, class Function, class Location>
 class EdgeData;
 
-template<class Container, class Functions, class Function>
-bool operator<(EdgeData<Container, Functions, Function> const& edge1,
-               EdgeData<Container, Functions, Function> const& edge2);
+template<class Container, class Functions, class Function, class Location>
+bool operator<(EdgeData<Container, Functions, Function, Location> const& edge1,
+               EdgeData<Container, Functions, Function, Location> const& edge2);
 
-template<class Container, class Functions, class Function>
+template<class Container, class Functions, class Function, class Location>
 class EdgeData : public ElementBase<Container> {
 public:
   EdgeData(Function const& caller, Function const& callee);
@@ -31,11 +32,15 @@ public:
   Function const& get_callee(void) const { return *M_KEY_callee; }
   typename Functions::iterator get_caller_iter(void) const { return M_KEY_caller; }
   typename Functions::iterator get_callee_iter(void) const { return M_KEY_callee; }
+  // The locations of the calls from the caller to the callee, sorted.
+  typename Location::container_type const& call_sites(void) const { return M_call_sites; }
+  typename Location::container_type& call_sites(void) { return M_call_sites; }
   friend bool operator< <>(EdgeData const& edge1, EdgeData const& edge2);
 
 private:
   typename Functions::iterator M_KEY_caller;  
   typename Functions::iterator M_KEY_callee;
+  typename Location::container_type M_call_sites;
 
 private:
   // Serialization.
@@ -46,6 +51,7 @@ private:
   {
     ar & SERIALIZATION_ITERATOR_NVP(Function::container, M_KEY_caller);
     ar & SERIALIZATION_ITERATOR_NVP(Function::container, M_KEY_callee);
+    // The call sites are not serialized: a Location refers to a FileName by its id, which is only valid in this process.
   }
 };
 
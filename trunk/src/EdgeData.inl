@@ -15,16 +15,18 @@
 #include "EdgeData.h"
 #include "Function.h"
 
-template<class Container, class Functions, class Function>
-EdgeData<Container, Functions, Function>::EdgeData(Function const& caller, Function const& callee) :
+template<class Container, class Functions, class Function, class Location>
+EdgeData<Container, Functions, Function, Location>::EdgeData(Function const& caller, Function const& callee) :
     M_KEY_caller(caller.get_iter()), M_KEY_callee(callee.get_iter()) { }
 
-template<class Container, class Functions, class Function>
-inline bool operator<(EdgeData<Container, Functions, Function> const& edge1,
-                      EdgeData<Container, Functions, Function> const& edge2)
+template<class Container, class Functions, class Function, class Location>
+inline bool operator<(EdgeData<Container, Functions, Function, Location> const& edge1,
+                      EdgeData<Container, Functions, Function, Location> const& edge2)
 {
-  return *edge1.M_KEY_caller < *edge2.M_KEY_caller ||
-      (!(*edge2.M_KEY_caller < *edge1.M_KEY_caller) && *edge1.M_KEY_callee < *edge2.M_KEY_callee);
+  // Every Function is stored only once, so equal functions have equal iterators.
+  if (edge1.M_KEY_caller != edge2.M_KEY_caller)
+    return *edge1.M_KEY_caller < *edge2.M_KEY_caller;
+  return edge1.M_KEY_callee != edge2.M_KEY_callee && *edge1.M_KEY_callee < *edge2.M_KEY_callee;
 }
 
 #endif // EDGEDATA_INL
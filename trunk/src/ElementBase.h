@@ -14,54 +14,116 @@
 
 #include <set>
 #include <list>
+#include <vector>
+#include <stdint.h>
 
+// Every element is stored once in container, and has a dense id: elements are numbered
+// in the order in which they are added, starting at 0. by_id finds an element by its id
+// in constant time; the ids of erased elements are never reused.
 template<class Container>
 class ElementBase {
 public:
   typedef Container container_type;				// Type of container storing derived elements.
-  static container_type container;				// The actual container.
+  typedef uint32_t id_type;
+  static container_type& container;				// The actual container; never destroyed, see Arena.
 
 public:
   static void initialize_serialization_index(void);		// Initialize M_serialization_index.
 
   int get_serialization_index(void) const { return M_serialization_index; }
-  static typename Container::iterator get_serialization_iter(int index) { container.begin() + index; }
+  static typename Container::iterator get_serialization_iter(int index) { return S_by_serialization_index[index]; }
   typename Container::iterator get_iter(void) const { return M_iter; }
 
+  id_type id(void) const { return M_id; }
+  // Return the element with id 'id', or container.end() if it was erased.
+  static typename Container::iterator by_id(id_type id) { return S_by_id[id]; }
+  // The number of ids handed out so far, including those of erased elements.
+  static id_type id_count(void) { return S_by_id.size(); }
+  // Erase the element at 'iter' from container.
+  static void remove(typename Container::iterator iter);
+
 protected:
   // Add element to container and initialize M_iter.
-  template<typename T>
-  bool add(std::set<T> const&, typename std::set<T>::value_type const& element);
+  template<typename T, typename Compare, typename Allocator>
+  bool add(std::set<T, Compare, Allocator> const&, typename std::set<T, Compare, Allocator>::value_type const& element);
+  // The same, but element is inserted right before 'hint' if it belongs there; that takes
+  // constant time, so that a set can be built from sorted elements in linear time.
+  template<typename T, typename Compare, typename Allocator>
+  bool add(std::set<T, Compare, Allocator> const&, typename std::set<T, Compare, Allocator>::iterator hint,
+      typename std::set<T, Compare, Allocator>::value_type const& element);
 
 public:
   template<typename T>
   void add(std::list<T> const&, typename std::list<T>::value_type const& element);
 
+private:
+  // Called by add: give the element at M_iter an id if it was inserted, and copy its id.
+  void set_id(bool inserted);
+
 protected:
   typename Container::iterator M_iter;				// Iterator to self.
+  id_type M_id;
   int M_serialization_index;
+  static std::vector<typename Container::iterator> S_by_id;	// Indexed by id.
+  static std::vector<typename Container::iterator> S_by_serialization_index;
 };
 
+template<class Container>
+void ElementBase<Container>::set_id(bool inserted)
+{
+  if (inserted)
+  {
+    const_cast<typename Container::value_type&>(*M_iter).M_id = S_by_id.size();
+    S_by_id.push_back(M_iter);
+  }
+  M_id = M_iter->M_id;
+}
+
+template<class Container>
+void ElementBase<Container>::remove(typename Container::iterator iter)
+{
+  S_by_id[iter->M_id] = container.end();
+  container.erase(iter);
+}
+
 template<class Container>
 void ElementBase<Container>::initialize_serialization_index(void)
 {
   int count = 0;
+  S_by_serialization_index.clear();
   // Run over the all objects in the same order as that they will be serialized,
   // and assign an index count.
   for (typename Container::iterator iter = container.begin(); iter != container.end(); ++iter)
+  {
     const_cast<typename Container::value_type&>(*iter).M_serialization_index = count++;
+    S_by_serialization_index.push_back(iter);
+  }
 }
 
 template<class Container>
-template<class T>
-bool ElementBase<Container>::add(std::set<T> const&, typename std::set<T>::value_type const& element)
+template<class T, class Compare, class Allocator>
+bool ElementBase<Container>::add(std::set<T, Compare, Allocator> const&, typename std::set<T, Compare, Allocator>::value_type const& element)
 {
   std::pair<typename Container::iterator, bool> result = T::container.insert(element);
   M_iter = result.first;
   const_cast<T&>(*M_iter).M_iter = M_iter;
+  set_id(result.second);
   return result.second;
 }
 
+template<class Container>
+template<class T, class Compare, class Allocator>
+bool ElementBase<Container>::add(std::set<T, Compare, Allocator> const&, typename std::set<T, Compare, Allocator>::iterator hint,
+    typename std::set<T, Compare, Allocator>::value_type const& element)
+{
+  size_t const size = T::container.size();
+  M_iter = T::container.insert(hint, element);
+  const_cast<T&>(*M_iter).M_iter = M_iter;
+  bool const inserted = T::container.size() != size;
+  set_id(inserted);
+  return inserted;
+}
+
 template<class Container>
 template<class T>
 void ElementBase<Container>::add(std::list<T> const&, typename std::list<T>::value_type const& element)
@@ -70,9 +132,16 @@ void ElementBase<Container>::add(std::list<T> const&, typename std::list<T>::val
   M_iter = T::container.end();
   --M_iter;
   const_cast<T&>(*M_iter).M_iter = M_iter;
+  set_id(true);
 }
 
 template<class Container>
-typename ElementBase<Container>::container_type ElementBase<Container>::container;
+typename ElementBase<Container>::container_type& ElementBase<Container>::container(*new typename ElementBase<Container>::container_type);
+
+template<class Container>
+std::vector<typename Container::iterator> ElementBase<Container>::S_by_id;
+
+template<class Container>
+std::vector<typename Container::iterator> ElementBase<Container>::S_by_serialization_index;
 
 #endif // ELEMENTBASE_H
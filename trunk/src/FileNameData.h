@@ -25,7 +25,7 @@ public:
     LongName<Container>((filename[0] == '/') ? collapsedpath(filename) : filename) { }
 
 public:
-  bool is_real_name(void) const { return this->M_KEY_long_name[0] == '/'; }
+  bool is_real_name(void) const { return this->long_name()[0] == '/'; }
   Project const& get_project(void) const { return *M_project; }
   bool is_source_file(void) const { return M_is_source_file; }
 
@@ -37,6 +37,7 @@ public:
 protected:
   Project::container_type::iterator M_project;
   bool M_is_source_file;			// Set when filename ends on .cc, .cpp, .cxx or .C.
+  static SymbolIndex<typename Container::value_type> S_index;	// Finds the elements of container by long name.
 
 private:
   // Serialization.
@@ -51,4 +52,7 @@ private:
   }
 };
 
+template<class Container>
+SymbolIndex<typename Container::value_type> FileNameData<Container>::S_index;
+
 #endif // FILENAMEDATA_H
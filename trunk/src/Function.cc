@@ -18,13 +18,63 @@ Function::Function(std::string const& function_name, FileName const& filename,
     CGDFile::container_type::const_iterator cgd_file) :
     FunctionData<Functions, CGDFile, FileName, Project, Classes, FunctionDecl, Edges>(function_name, filename, cgd_file)
 {
-  add(container, *this);
+  add_to_container();
   const_cast<Function&>(*M_iter).set_definition(cgd_file);
 }
 
+Function::Function(Symbol function_name, FileName const& filename, Functions::iterator hint) :
+    FunctionData<Functions, CGDFile, FileName, Project, Classes, FunctionDecl, Edges>(function_name, filename)
+{
+  if (add(container, hint, *this) && !S_index.find(M_KEY_function_name))
+    S_index.insert(M_KEY_function_name, *M_iter);
+}
+
+void Function::add_to_container(void)
+{
+  // Nearly all functions are known already, and almost all names are declared in only one file.
+  Function const* known = S_index.find(M_KEY_function_name);
+  if (known && known->M_KEY_decl_file == M_KEY_decl_file)
+  {
+    M_iter = known->get_iter();
+    M_id = known->M_id;
+    return;
+  }
+  add(container, *this);
+  if (!known)
+    S_index.insert(M_KEY_function_name, *M_iter);
+}
+
+void Function::erase(std::vector<Functions::iterator> const& functions)
+{
+  if (functions.empty())
+    return;
+  // Also erase the edges of the functions, they would refer to them after they are gone.
+  // Erasing is rare, so do that in a single run over all edges.
+  std::vector<bool> erased(id_count(), false);
+  for (std::vector<Functions::iterator>::const_iterator iter = functions.begin(); iter != functions.end(); ++iter)
+    erased[(*iter)->id()] = true;
+  for (Edges::iterator edge = Edge::container.begin(); edge != Edge::container.end();)
+  {
+    Edges::iterator next = edge;
+    ++next;
+    if (erased[edge->get_caller_iter()->id()] || erased[edge->get_callee_iter()->id()])
+      Edge::remove(edge);
+    edge = next;
+  }
+  for (std::vector<Functions::iterator>::const_iterator iter = functions.begin(); iter != functions.end(); ++iter)
+  {
+    S_index.erase((*iter)->M_KEY_function_name, **iter);
+    remove(*iter);
+  }
+}
+
 void Function::add_callee(Function const& callee)
 {
-  Edge edge(*this, callee);
-  this->edges_out().push_back(edge.get_iter());
-  const_cast<Function&>(*callee.get_iter()).edges_in().push_back(edge.get_iter());
+  add_callee(callee, Edge::container.end());
+}
+
+Edges::iterator Function::add_callee(Function const& callee, Edges::iterator hint)
+{
+  Edge edge(*this, callee, hint);
+  return edge.get_iter();
 }
@@ -15,6 +15,7 @@
 #include <vector>
 #include "Node.h"
 #include "ElementBase.h"
+#include "Symbol.h"
 #include "serialization.h"
 #include "debug.h"
 
@@ -30,21 +31,25 @@ class FunctionData : public Node, public ElementBase<Container> {
 public:
   FunctionData(std::string const& function_name, FileName const& filename,
            typename CGDFile::container_type::const_iterator cgd_file) :
-      M_KEY_function_name(function_name), M_KEY_decl_file(filename.get_iter()), M_definition(true), M_cgd_file(cgd_file) { }
+      M_KEY_function_name(function_name), M_KEY_decl_file(filename.get_iter()), M_definition(true), M_cgd_file(cgd_file),
+      M_decl_state(decl_unparsed) { }
   FunctionData(std::string const& function_name, FileName const& filename) :
-      M_KEY_function_name(function_name), M_KEY_decl_file(filename.get_iter()), M_definition(false) { }
+      M_KEY_function_name(function_name), M_KEY_decl_file(filename.get_iter()), M_definition(false),
+      M_decl_state(decl_unparsed) { }
+  FunctionData(Symbol function_name, FileName const& filename) :
+      M_KEY_function_name(function_name), M_KEY_decl_file(filename.get_iter()), M_definition(false),
+      M_decl_state(decl_unparsed) { }
 
-  std::string const& name(void) const { return M_KEY_function_name; }
+  std::string const& name(void) const { return M_KEY_function_name.str(); }
   bool has_definition(void) const { return M_definition; }
-  bool is_possibly_compiler_generated(void) const
-      { return M_decl.is_destructor() || M_decl.is_assignment() || M_decl.is_copy() || M_decl.is_default(); }
   typename CGDFile::container_type::const_iterator cgd_file(void) const { return M_cgd_file; }
-  std::vector<typename Edges::iterator> const& edges_out(void) const { return M_edges_out; }
-  std::vector<typename Edges::iterator>& edges_out(void) { return M_edges_out; }
-  std::vector<typename Edges::iterator> const& edges_in(void) const { return M_edges_in; }
-  std::vector<typename Edges::iterator>& edges_in(void) { return M_edges_in; }
-  FunctionDecl& decl(void) { return M_decl; }
-  FunctionDecl const& decl(void) const { return M_decl; }
+  // The declaration is parsed from the name the first time that it is needed (see Function::parse_decl).
+  FunctionDecl const& decl(void) const
+  {
+    if (M_decl_state == decl_unparsed)
+      static_cast<typename Container::value_type const*>(this)->parse_decl();
+    return M_decl;
+  }
   Class const& get_class(void) const { return *M_class_iter; }
   FileName const& get_file(void) const { return *M_KEY_decl_file; }
   Project const& get_project(void) const { return *M_project_iter; }
@@ -53,7 +58,7 @@ public:
   {
     return fn1.M_KEY_function_name < fn2.M_KEY_function_name ||
         (fn1.M_KEY_function_name == fn2.M_KEY_function_name &&
-	 *fn1.M_KEY_decl_file < *fn2.M_KEY_decl_file);
+	 fn1.M_KEY_decl_file != fn2.M_KEY_decl_file && *fn1.M_KEY_decl_file < *fn2.M_KEY_decl_file);
   }
 
 protected:
@@ -62,20 +67,21 @@ protected:
   virtual NodeType node_type(void) const { return function_node; }
 
 protected:
-  std::string M_KEY_function_name;
+  Symbol M_KEY_function_name;
   typename FileName::container_type::iterator M_KEY_decl_file;
   bool M_definition;
   typename CGDFile::container_type::const_iterator M_cgd_file;
-  std::vector<typename Edges::iterator> M_edges_out;
-  std::vector<typename Edges::iterator> M_edges_in;
-  FunctionDecl M_decl;
+  enum decl_state_type { decl_unparsed, decl_parsed, decl_invalid };
+  mutable FunctionDecl M_decl;
+  mutable decl_state_type M_decl_state;
   typename Classes::iterator M_class_iter;
   typename Project::container_type::iterator M_project_iter;
+  static SymbolIndex<typename Container::value_type> S_index;	// Finds the elements of container by name.
 
 private:
   // Serialization.
   friend class boost::serialization::access;
-  FunctionData(void) { }	// Uninitialized object (needed for serialization).
+  FunctionData(void) : M_decl_state(decl_unparsed) { }	// Uninitialized object (needed for serialization).
   template<class Archive>
   void serialize(Archive& ar, unsigned int const version);
 };
@@ -90,6 +96,9 @@ std::ostream& operator<<(std::ostream& os,
 }
 #endif
 
+template<class Container, class CGDFile, class FileName, class Project, class Classes, class FunctionDecl, class Edges>
+SymbolIndex<typename Container::value_type> FunctionData<Container, CGDFile, FileName, Project, Classes, FunctionDecl, Edges>::S_index;
+
 #endif // FUNCTIONDATA_H
 
 #ifndef FUNCTIONDATA2_H
@@ -102,16 +111,15 @@ template<class Archive>
 void FunctionData<Container, CGDFile, FileName, Project, Classes, FunctionDecl, Edges>::
     serialize(Archive& ar, unsigned int const UNUSED(version))
 {
-  ar & BOOST_SERIALIZATION_NVP(M_KEY_function_name);
+  std::string function_name(M_KEY_function_name.str());
+  ar & boost::serialization::make_nvp("M_KEY_function_name", function_name);
+  M_KEY_function_name = Symbol(function_name);
   ar & SERIALIZATION_ITERATOR_NVP(FileName::container, M_KEY_decl_file);
   ar & BOOST_SERIALIZATION_NVP(M_definition);
   if (M_definition)
     ar & SERIALIZATION_ITERATOR_NVP(CGDFile::container, M_cgd_file);
-  ar & BOOST_SERIALIZATION_NVP(M_decl);
   ar & SERIALIZATION_ITERATOR_NVP(Class::container, M_class_iter);
   ar & SERIALIZATION_ITERATOR_NVP(Project::container, M_project_iter);
-  ar & SERIALIZATION_ITERATOR_NVP(Edge::container, M_edges_out);
-  ar & SERIALIZATION_ITERATOR_NVP(Edge::container, M_edges_in);
 }
 
 #endif // FUNCTIONDATA2_H
@@ -11,32 +11,42 @@
 
 #include "sys.h"
 #include "FunctionDecl.h"
+#include "Function.h"
+#include "parser.h"
 #include <iostream>
 #include "debug.h"
 
 void FunctionDecl::clear(void)
 {
-  return_type.clear();
-  function_pointer.clear();
+  return_type = DeclSlice();
+  function_pointer = DeclSlice();
   class_or_namespaces.clear();
   classes.clear();
-  function_name.clear();
+  function_name = DeclSlice();
   parameter_types.clear();
-  function_qualifiers.clear();
-  exception_specification.clear();
+  function_qualifiers = DeclSlice();
+  exception_specification = DeclSlice();
+}
+
+void FunctionDecl::reset(std::string const& input)
+{
+  clear();
+  decl_specifier = DeclSlice();
+  M_input = input.c_str();
+  M_is_constructor = M_is_destructor = M_is_assignment = M_is_copy = M_is_default = M_is_template = M_is_C_function = false;
 }
 
 std::string FunctionDecl::self_const_reference(void) const
 {
   std::string result = "const ";
   bool first = true;
-  for (std::vector<std::string>::const_iterator iter = class_or_namespaces.begin(); iter != class_or_namespaces.end(); ++iter)
+  for (std::vector<DeclSlice>::const_iterator iter = class_or_namespaces.begin(); iter != class_or_namespaces.end(); ++iter)
   {
     if (first)
       first = false;
     else
       result += "::";
-    result += *iter;
+    append(result, *iter);
   }
   for (std::vector<ClassDecl>::const_iterator iter = classes.begin(); iter != classes.end(); ++iter)
   {
@@ -44,8 +54,8 @@ std::string FunctionDecl::self_const_reference(void) const
       first = false;
     else
       result += "::";
-    result += iter->name();
-    result += iter->template_argument_list();
+    append(result, iter->name());
+    append(result, iter->template_argument_list());
   }
   result += '&';
   return result;
@@ -103,9 +113,9 @@ std::string FunctionDecl::self_const_reference(void) const
 // ,	binary
 bool FunctionDecl::is_class_operator(void) const
 {
-  if (function_name.substr(0, 8) != "operator")
+  if (!starts_with(function_name, "operator"))
     return false;
-  std::string operator_r = function_name.substr(8);
+  std::string operator_r(M_input + function_name.offset + 8, function_name.length - 8);
   // Detect if this is operator 'new', 'delete' or a casting operator.
   if (operator_r[0] == ' ')
   {
@@ -116,14 +126,14 @@ bool FunctionDecl::is_class_operator(void) const
       return !(class_or_namespaces.empty() && classes.empty());
     }
     // Must be a casting operator.
-    assert(return_type.size() == 0);
+    assert(return_type.empty());
     return true;
   }
   // Otherwise, check if this is an increment or decrement operator.
   if (operator_r == "++" || operator_r == "--")
   {
     // These are only member functions if the argument is void or int.
-    return (parameter_types.size() == 1 && (parameter_types[0] == "int" || parameter_types[0] == "void"));
+    return (parameter_types.size() == 1 && (parameter_types[0].str() == "int" || parameter_types[0].str() == "void"));
   }
   // Otherwise, check if this is a unary operator without arguments.
   if (parameter_types.size() == 0)
@@ -141,8 +151,7 @@ bool FunctionDecl::is_class_operator(void) const
     if (c == '*' || c == '&' || c == '+' || c== '-')
     {
       // FIXME: return true if the parameter is a builtin-type.
-      std::string param = parameter_types[0];
-      return param == "int";
+      return parameter_types[0].str() == "int";
     }
     // These are unary operators.
     if (c == '!' || c == '~')
@@ -152,24 +161,72 @@ bool FunctionDecl::is_class_operator(void) const
   return true;
 }
 
+// The members of Function that parse declarations are defined here, so that the
+// programs that don't look at declarations don't have to link with the parser.
+
+std::set<std::string> Function::S_types;
+
+bool Function::parse_decl(void) const
+{
+  if (M_decl_state == decl_unparsed)
+  {
+    // 'Special' functions, whose name starts with a '(', don't have a declaration.
+    if (name()[0] == '(' || parse_function_declaration(name(), M_decl, S_types))
+      M_decl_state = decl_parsed;
+    else
+      M_decl_state = decl_invalid;
+  }
+  return M_decl_state == decl_parsed;
+}
+
+bool Function::is_template(void) const
+{
+  // A template has template parameters ("[with T = int]") or a class with a template argument list,
+  // so it needs a '<' that doesn't start the name of an anonymous namespace.
+  std::string const& function_name(name());
+  bool may_be_template = function_name.find("[with") != std::string::npos;
+  for (size_t pos = function_name.find('<'); !may_be_template && pos != std::string::npos; pos = function_name.find('<', pos + 1))
+    may_be_template = function_name.compare(pos, 9, "<unnamed@") != 0;
+  return may_be_template && decl().is_template();
+}
+
+bool Function::is_possibly_compiler_generated(void) const
+{
+  // Destructors and assignment operators can be recognized by their name. Constructors
+  // don't have a return type: they have no space before the template arguments or parameters.
+  std::string const& function_name(name());
+  if (function_name.find('~') == std::string::npos && function_name.find("operator=") == std::string::npos &&
+      function_name.find(' ') < function_name.find_first_of("<("))
+    return false;
+  FunctionDecl const& function_decl(decl());
+  return function_decl.is_destructor() || function_decl.is_assignment() || function_decl.is_copy() || function_decl.is_default();
+}
+
+bool Function::function_name_starts_with(char const* prefix) const
+{
+  if (name().find(prefix) == std::string::npos)
+    return false;
+  return decl().starts_with(decl().function_name, prefix);
+}
+
 #ifdef CWDEBUG
 std::ostream& operator<<(std::ostream& os, FunctionDecl const& decl)
 {
   if (!decl.return_type.empty())
   {
-    os << decl.return_type << ' ';
+    os << decl.str(decl.return_type) << ' ';
     if (!decl.function_pointer.empty())
       os << "(*";
   }
   bool first = true;
-  for (std::vector<std::string>::const_iterator iter = decl.class_or_namespaces.begin();
+  for (std::vector<DeclSlice>::const_iterator iter = decl.class_or_namespaces.begin();
        iter != decl.class_or_namespaces.end(); ++iter)
   {
     if (!first)
       os << "::";
     else
       first = false;
-    os << *iter;
+    os << decl.str(*iter);
   }
   for (std::vector<ClassDecl>::const_iterator iter = decl.classes.begin(); iter != decl.classes.end(); ++iter)
   {
@@ -177,27 +234,27 @@ std::ostream& operator<<(std::ostream& os, FunctionDecl const& decl)
       os << "::";
     else
       first = false;
-    os << *iter;
+    os << decl.str(iter->name()) << decl.str(iter->template_argument_list());
   }
   if (!first)
     os << "::";
-  os << decl.function_name << '(';
+  os << decl.str(decl.function_name) << '(';
   first = true;
-  for (std::vector<std::string>::const_iterator iter = decl.parameter_types.begin(); iter != decl.parameter_types.end(); ++iter)
+  for (std::vector<Symbol>::const_iterator iter = decl.parameter_types.begin(); iter != decl.parameter_types.end(); ++iter)
   {
     if (!first)
       os << ", ";
     else
       first = false;
-    os << *iter;
+    os << iter->str();
   }
   if (first && !decl.is_C_function())
     os << "void";
   os << ')';
   if (decl.has_function_qualifiers())
-    os << ' ' << decl.function_qualifiers;
+    os << ' ' << decl.str(decl.function_qualifiers);
   if (!decl.function_pointer.empty())
-    os << decl.function_pointer;
+    os << decl.str(decl.function_pointer);
   return os;
 }
 #endif
@@ -14,22 +14,29 @@
 
 #include <string>
 #include <vector>
+#include <cstring>
 #include "ClassDecl.h"
+#include "Symbol.h"
 #include <iostream>
-#include "serialization.h"
 
+// A parsed function declaration.
+//
+// The parts of the declaration are slices of the string that it was parsed from
+// (see parse_function_declaration), the types of the parameters are interned.
+// Declarations are not stored: they are parsed again from the function name.
 struct FunctionDecl {
-  std::string decl_specifier;
-  std::string return_type;
-  std::string function_pointer;
-  std::vector<std::string> class_or_namespaces;
+  DeclSlice decl_specifier;
+  DeclSlice return_type;
+  DeclSlice function_pointer;
+  std::vector<DeclSlice> class_or_namespaces;
   std::vector<ClassDecl> classes;
-  std::string function_name;
-  std::vector<std::string> parameter_types;
-  std::string function_qualifiers;
-  std::string exception_specification;
+  DeclSlice function_name;
+  std::vector<Symbol> parameter_types;
+  DeclSlice function_qualifiers;
+  DeclSlice exception_specification;
 
 private:
+  char const* M_input;			// The string that the slices refer to.
   bool M_is_constructor;		// For example: N::Foo<T>::Foo(int, double)
   bool M_is_destructor;			// For example: virtual N::Foo<T>::~Foo()
   bool M_is_assignment;			// For example: N::Foo& N::Foo::operator=(const N::Foo&)
@@ -39,10 +46,13 @@ private:
   bool M_is_C_function;
 
 public:
-  FunctionDecl(void) : M_is_constructor(false), M_is_destructor(false), M_is_assignment(false),
+  FunctionDecl(void) : M_input(""), M_is_constructor(false), M_is_destructor(false), M_is_assignment(false),
       M_is_copy(false), M_is_default(false), M_is_template(false), M_is_C_function(false) { }
 
   void clear(void);
+  // Forget everything, before parsing 'input'. The slices will refer to 'input',
+  // which therefore must not move or change anymore.
+  void reset(std::string const& input);
   void set_constructor(void) { M_is_constructor = true; }
   void set_destructor(void) { M_is_destructor = true; }
   void set_assignment(void) { M_is_assignment = true; }
@@ -52,6 +62,15 @@ public:
   void set_is_template(void) { M_is_template = true; }
   void set_is_C_function(void) { M_is_C_function = true; }
 
+  // Access the text of a slice of this declaration.
+  std::string str(DeclSlice slice) const { return std::string(M_input + slice.offset, slice.length); }
+  void append(std::string& result, DeclSlice slice) const { result.append(M_input + slice.offset, slice.length); }
+  Symbol symbol(DeclSlice slice) const { return Symbol(M_input + slice.offset, slice.length); }
+  bool equals(DeclSlice slice, char const* str) const
+      { return std::strlen(str) == slice.length && std::strncmp(M_input + slice.offset, str, slice.length) == 0; }
+  bool starts_with(DeclSlice slice, char const* prefix) const
+      { size_t len = std::strlen(prefix); return len <= slice.length && std::strncmp(M_input + slice.offset, prefix, len) == 0; }
+
   bool is_constructor(void) const { return M_is_constructor; }
   bool is_destructor(void) const { return M_is_destructor; }
   bool has_template_argument_list(void) const { return !classes.empty() && classes.back().has_template_argument_list(); }
@@ -72,30 +91,6 @@ public:
   bool is_class_operator(void) const;
 
   std::string self_const_reference(void) const;
-
-private:
-  // Serialization.
-  friend class boost::serialization::access;
-  template<class Archive>
-  void serialize(Archive& ar, unsigned int const UNUSED(version))
-  {
-    ar & BOOST_SERIALIZATION_NVP(decl_specifier);
-    ar & BOOST_SERIALIZATION_NVP(return_type);
-    ar & BOOST_SERIALIZATION_NVP(function_pointer);
-    ar & BOOST_SERIALIZATION_NVP(class_or_namespaces);
-    ar & BOOST_SERIALIZATION_NVP(classes);
-    ar & BOOST_SERIALIZATION_NVP(function_name);
-    ar & BOOST_SERIALIZATION_NVP(parameter_types);
-    ar & BOOST_SERIALIZATION_NVP(function_qualifiers);
-    ar & BOOST_SERIALIZATION_NVP(exception_specification);
-    ar & BOOST_SERIALIZATION_NVP(M_is_constructor);
-    ar & BOOST_SERIALIZATION_NVP(M_is_destructor);
-    ar & BOOST_SERIALIZATION_NVP(M_is_assignment);
-    ar & BOOST_SERIALIZATION_NVP(M_is_copy);
-    ar & BOOST_SERIALIZATION_NVP(M_is_default);
-    ar & BOOST_SERIALIZATION_NVP(M_is_template);
-    ar & BOOST_SERIALIZATION_NVP(M_is_C_function);
-  }
 };
 
 #endif // FUNCTIONDECL_H
@@ -46,6 +46,8 @@ void Graph::write_to(std::ostream& os)
 {
   os << "digraph G {\n";
   os << "  rankdir = BT;\n";
+  if (!M_label.empty())
+    os << "  label = \"" << M_label << "\";\n  labelloc = t;\n";
   for (std::vector<Node*>::iterator vertex_iter = M_vertex_vec.begin(); vertex_iter != M_vertex_vec.end(); ++vertex_iter)
   {
     os << "  " << (*vertex_iter)->get_index() <<
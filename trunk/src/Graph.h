@@ -15,11 +15,13 @@
 #include "Node.h"
 #include <vector>
 #include <set>
+#include <string>
 #include <iosfwd>
 #include <boost/graph/graph_traits.hpp>
 #include <boost/graph/adjacency_list.hpp>
 #include "Edge.h"
 #include "Function.h"
+#include "CallGraph.h"
 
 class Graph {
 public:
@@ -30,8 +32,11 @@ private:
   std::set<std::pair<size_t, size_t> > M_edges;
   graph_type M_g;
   std::vector<int> M_distance_vec;
+  std::string M_label;
 public:
   size_t number_of_vertices(void) const { return M_vertex_vec.size(); }
+  // Print 'label' at the top of the graph.
+  void set_label(std::string const& label) { M_label = label; }
   void add_vertex(Node* node);
   void add_edge(Node* u, Node* v);
   void write_to(std::ostream& os);
@@ -45,16 +50,24 @@ public:
 template<typename CallerFilter, typename CalleeFilter>
 void Graph::generate_graph(CallerFilter caller_filter, CalleeFilter callee_filter)
 {
-  for (Edge::container_type::iterator edge_iter = Edge::container.begin(); edge_iter != Edge::container.end(); ++edge_iter)
+  // Run over the edges in the order of Edge::container, see CallGraph.
+  for (Functions::iterator caller_iter = Function::container.begin(); caller_iter != Function::container.end(); ++caller_iter)
   {
-    Function& caller(const_cast<Function&>(edge_iter->get_caller()));
-    if (caller_filter(caller))
+    CallGraph::const_iterator const callees_end = call_graph.callees_end(caller_iter->id());
+    CallGraph::const_iterator callee_id = call_graph.callees_begin(caller_iter->id());
+    if (callee_id == callees_end)
       continue;
-    Function& callee(const_cast<Function&>(edge_iter->get_callee()));
-    if (callee_filter(callee))
+    Function& caller(const_cast<Function&>(*caller_iter));
+    if (caller_filter(caller))
       continue;
-    Dout(dc::notice, "Adding " << caller << " calls " << callee);
-    add_edge(caller.get_node(caller_filter.type), callee.get_node(callee_filter.type));
+    for (; callee_id != callees_end; ++callee_id)
+    {
+      Function& callee(const_cast<Function&>(*Function::by_id(*callee_id)));
+      if (callee_filter(callee))
+	continue;
+      Dout(dc::notice, "Adding " << caller << " calls " << callee);
+      add_edge(caller.get_node(caller_filter.type), callee.get_node(callee_filter.type));
+    }
   }
 
   // Add the vertices to the boost graph object.
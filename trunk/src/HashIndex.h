@@ -0,0 +1,76 @@
+// cppgraph -- C++ call graph analyzer
+//
+//! @file HashIndex.h
+//! @brief This file contains the declaration and implementation of class HashIndex.
+//
+// Copyright (C) 2006, by Timmy <timmy1992@gmail.com>
+//
+// This file may be distributed under the terms of the Q Public License
+// version 1.0 as appearing in the file LICENSE.QPL included in the
+// packaging of this file.
+
+#ifndef HASHINDEX_H
+#define HASHINDEX_H
+
+#include <cstddef>
+#include <vector>
+#include <stdint.h>
+
+// An open addressing hash table that maps keys to 32 bit values.
+// Key must have a member function hash() and an operator==.
+template<typename Key>
+class HashIndex {
+private:
+  struct Slot {
+    Key key;
+    uint32_t value;			// 'none' for an empty slot.
+  };
+  std::vector<Slot> M_slots;		// Kept at most half full.
+  size_t M_size;
+
+  // Return the slot of 'key', or the empty slot where it belongs.
+  Slot& slot(Key const& key)
+  {
+    size_t const mask = M_slots.size() - 1;
+    for (size_t index = key.hash() & mask;; index = (index + 1) & mask)
+      if (M_slots[index].value == none || M_slots[index].key == key)
+	return M_slots[index];
+  }
+
+public:
+  static uint32_t const none = 0xffffffff;
+
+  HashIndex(void) { clear(); }
+
+  // Return the value of 'key', or none.
+  uint32_t find(Key const& key) { return slot(key).value; }
+
+  // Add 'key', that is not in the table yet.
+  void insert(Key const& key, uint32_t value)
+  {
+    if (2 * (M_size + 1) > M_slots.size())
+    {
+      std::vector<Slot> slots(2 * M_slots.size());
+      for (typename std::vector<Slot>::iterator iter = slots.begin(); iter != slots.end(); ++iter)
+	iter->value = none;
+      slots.swap(M_slots);
+      for (typename std::vector<Slot>::iterator iter = slots.begin(); iter != slots.end(); ++iter)
+	if (iter->value != none)
+	  slot(iter->key) = *iter;
+    }
+    Slot& entry(slot(key));
+    entry.key = key;
+    entry.value = value;
+    ++M_size;
+  }
+
+  void clear(void)
+  {
+    Slot const empty = { Key(), none };
+    std::vector<Slot>(1024, empty).swap(M_slots);
+    M_size = 0;
+  }
+};
+
+
+#endif // HASHINDEX_H
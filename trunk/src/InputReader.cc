@@ -0,0 +1,145 @@
+// cppgraph -- C++ call graph analyzer
+//
+//! @file InputReader.cc
+//! @brief This file contains the implementation of the mmap and pread input readers.
+//
+// Copyright (C) 2006, by Timmy <timmy1992@gmail.com>
+//
+// This file may be distributed under the terms of the Q Public License
+// version 1.0 as appearing in the file LICENSE.QPL included in the
+// packaging of this file.
+
+#include "sys.h"
+#include <cerrno>
+#include <cstring>
+#include <cstdlib>
+#include <stdexcept>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include "InputReader.h"
+#include "UringReader.h"
+#include "MappedFile.h"
+#include "exceptions.h"
+#include "debug.h"
+
+namespace {
+
+// Reads the files by mapping them into memory.
+class MmapReader : public InputReader {
+private:
+  std::vector<std::string const*> const& M_filenames;
+  std::vector<MappedFile*> M_files;
+
+public:
+  MmapReader(std::vector<std::string const*> const& filenames) : M_filenames(filenames), M_files(filenames.size()) { }
+  ~MmapReader()
+  {
+    for (std::vector<MappedFile*>::iterator iter = M_files.begin(); iter != M_files.end(); ++iter)
+      delete *iter;
+  }
+
+  virtual void get(size_t index, char const*& begin, size_t& size)
+  {
+    M_files[index] = new MappedFile(*M_filenames[index]);
+    begin = M_files[index]->begin();
+    size = M_files[index]->size();
+  }
+
+  virtual void release(size_t index)
+  {
+    delete M_files[index];
+    M_files[index] = NULL;
+  }
+
+  virtual char const* name(void) const { return "mmap"; }
+};
+
+// Reads the files with open, fstat, pread and close.
+class PreadReader : public InputReader {
+private:
+  std::vector<std::string const*> const& M_filenames;
+  std::vector<char*> M_buffers;
+
+public:
+  PreadReader(std::vector<std::string const*> const& filenames) : M_filenames(filenames), M_buffers(filenames.size()) { }
+  ~PreadReader()
+  {
+    for (std::vector<char*>::iterator iter = M_buffers.begin(); iter != M_buffers.end(); ++iter)
+      free(*iter);
+  }
+
+  virtual void get(size_t index, char const*& begin, size_t& size);
+
+  virtual void release(size_t index)
+  {
+    free(M_buffers[index]);
+    M_buffers[index] = NULL;
+  }
+
+  virtual char const* name(void) const { return "pread"; }
+};
+
+void PreadReader::get(size_t index, char const*& begin, size_t& size)
+{
+  std::string const& filename(*M_filenames[index]);
+  int fd = open(filename.c_str(), O_RDONLY);
+  if (fd == -1)
+    THROW_EXCEPTION(std::runtime_error(filename + ": " + strerror(errno)),
+	"PreadReader::get(" << index << "): open failed");
+  struct stat statbuf;
+  if (fstat(fd, &statbuf) == -1)
+  {
+    int saved_errno = errno;
+    close(fd);
+    THROW_EXCEPTION(std::runtime_error("fstat: " + filename + ": " + strerror(saved_errno)),
+	"PreadReader::get(" << index << "): fstat failed");
+  }
+  size = statbuf.st_size;
+  char* buffer = static_cast<char*>(malloc(size + 1));	// Never malloc(0).
+  size_t done = 0;
+  while (done < size)
+  {
+    ssize_t len = pread(fd, buffer + done, size - done, done);
+    if (len == -1 && errno == EINTR)
+      continue;
+    if (len == -1)
+    {
+      int saved_errno = errno;
+      free(buffer);
+      close(fd);
+      THROW_EXCEPTION(std::runtime_error("read: " + filename + ": " + strerror(saved_errno)),
+	  "PreadReader::get(" << index << "): pread failed");
+    }
+    if (len == 0)
+      break;				// The file was truncated while we read it.
+    done += len;
+  }
+  close(fd);
+  size = done;
+  M_buffers[index] = buffer;
+  begin = buffer;
+}
+
+} // namespace
+
+InputReader* create_input_reader(io_backend_type io_backend, std::vector<std::string const*> const& filenames)
+{
+  switch (io_backend)
+  {
+    case io_backend_mmap:
+      return new MmapReader(filenames);
+    case io_backend_uring:
+    {
+      InputReader* reader = create_uring_reader(filenames);
+      if (reader)
+	return reader;
+      Dout(dc::notice, "io_uring is not available, falling back to pread.");
+      break;
+    }
+    case io_backend_pread:
+      break;
+  }
+  return new PreadReader(filenames);
+}
@@ -0,0 +1,51 @@
+// cppgraph -- C++ call graph analyzer
+//
+//! @file InputReader.h
+//! @brief This file contains the declaration of class InputReader.
+//
+// Copyright (C) 2006, by Timmy <timmy1992@gmail.com>
+//
+// This file may be distributed under the terms of the Q Public License
+// version 1.0 as appearing in the file LICENSE.QPL included in the
+// packaging of this file.
+
+#ifndef INPUTREADER_H
+#define INPUTREADER_H
+
+#include <string>
+#include <vector>
+#include <sys/types.h>
+
+// The different ways to read the input files.
+enum io_backend_type {
+  io_backend_mmap,		// Map each file into memory (default).
+  io_backend_pread,		// open/fstat/pread/close each file into a buffer.
+  io_backend_uring		// Batched asynchronous reads using Linux io_uring.
+};
+
+// Provides the contents of a fixed list of files.
+//
+// get() and release() may be called by different threads, but
+// not for the same index at the same time.
+class InputReader {
+public:
+  virtual ~InputReader() { }
+
+  // Return the contents of file number index in [begin, begin + size).
+  // The contents stay valid until release(index) is called.
+  // @throws std::runtime_error
+  virtual void get(size_t index, char const*& begin, size_t& size) = 0;
+
+  // Done with the contents of file number index.
+  virtual void release(size_t index) = 0;
+
+  // Return a human readable name of the backend.
+  virtual char const* name(void) const = 0;
+};
+
+// Create a reader for the files 'filenames'.  When io_backend_uring is requested but
+// io_uring can not be used on this system, a pread reader is returned instead.
+// The strings in 'filenames' must stay valid for the lifetime of the reader.
+InputReader* create_input_reader(io_backend_type io_backend, std::vector<std::string const*> const& filenames);
+
+#endif // INPUTREADER_H
@@ -0,0 +1,43 @@
+// cppgraph -- C++ call graph analyzer
+//
+//! @file Location.cc
+//! @brief This file contains the implementation of class Location.
+//
+// Copyright (C) 2006, by Timmy <timmy1992@gmail.com>
+//
+// This file may be distributed under the terms of the Q Public License
+// version 1.0 as appearing in the file LICENSE.QPL included in the
+// packaging of this file.
+
+#include "sys.h"
+#include <algorithm>
+#include <functional>
+#include "Location.h"
+#include "parallel_sort.h"
+#include "debug.h"
+
+Location::container_type& Location::container(*new Location::container_type);
+
+void Location::add(container_type& locations, int jobs)
+{
+  parallel_sort(locations.begin(), locations.end(), std::less<Location>(), jobs);
+  size_t const old_size = container.size();
+  if (old_size == 0)
+    container.swap(locations);
+  else
+  {
+    container.insert(container.end(), locations.begin(), locations.end());
+    std::inplace_merge(container.begin(), container.begin() + old_size, container.end());
+  }
+  container.erase(std::unique(container.begin(), container.end()), container.end());
+  container_type().swap(locations);
+}
+
+std::pair<Location::container_type::const_iterator, Location::container_type::const_iterator>
+    Location::lines(FileName const& file)
+{
+  Location const first(static_cast<key_type>(file.id()) << 32);
+  Location const last(static_cast<key_type>(file.id() + 1) << 32);
+  return std::make_pair(std::lower_bound(container.begin(), container.end(), first),
+      std::lower_bound(container.begin(), container.end(), last));
+}
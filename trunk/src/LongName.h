@@ -14,6 +14,7 @@
 
 #include <string>
 #include "ShortName.h"
+#include "Symbol.h"
 #include "debug.h"
 #include "serialization.h"
 
@@ -23,8 +24,11 @@ public:
   LongName(std::string const& long_name) : M_KEY_long_name(long_name) { }
 
   // Accessors.
-  std::string const& long_name(void) const { return M_KEY_long_name; }
+  std::string const& long_name(void) const { return M_KEY_long_name.str(); }
   std::string const& short_name(void) const { return M_shortname->str(); }
+  // The name that short names are taken from. Derived classes can hide this to give
+  // elements with different long names the same short name.
+  std::string const& short_name_source(void) const { return M_KEY_long_name.str(); }
 
   template<typename Iterator>
     static void init_short_name(Iterator longname_iter);
@@ -38,7 +42,7 @@ public:
       { return ln1.M_KEY_long_name < ln2.M_KEY_long_name; }
 
 protected:
-  std::string M_KEY_long_name;		// The full name.
+  Symbol M_KEY_long_name;		// The full name.
   typename ShortName<Container>::container_type::iterator M_shortname;
 
 private:
@@ -47,7 +51,9 @@ private:
   template<class Archive>
   void serialize(Archive& ar, unsigned int const UNUSED(version))
   {
-    ar & BOOST_SERIALIZATION_NVP(M_KEY_long_name);
+    std::string long_name(M_KEY_long_name.str());
+    ar & boost::serialization::make_nvp("M_KEY_long_name", long_name);
+    M_KEY_long_name = Symbol(long_name);
     typedef ShortName<Container> shortname_type;
     ar & SERIALIZATION_ITERATOR_NVP(shortname_type::container, M_shortname);
   }
@@ -59,10 +65,10 @@ template<class Container>
   template<typename Iterator>
     void LongName<Container>::init_short_name(Iterator longname_iter)
     {
-      std::string short_name = longname_iter->long_name();
-      std::string::size_type pos = longname_iter->long_name().rfind(Container::value_type::seperator());
+      std::string short_name = longname_iter->short_name_source();
+      std::string::size_type pos = longname_iter->short_name_source().rfind(Container::value_type::seperator());
       if (pos != std::string::npos && longname_iter->process())
-	short_name = longname_iter->long_name().substr(pos + 1);
+	short_name = longname_iter->short_name_source().substr(pos + 1);
       ShortName<Container>(short_name, longname_iter);
     }
 
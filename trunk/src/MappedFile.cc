@@ -0,0 +1,62 @@
+// cppgraph -- C++ call graph analyzer
+//
+//! @file MappedFile.cc
+//! @brief This file contains the implementation of class MappedFile.
+//
+// Copyright (C) 2006, by Timmy <timmy1992@gmail.com>
+//
+// This file may be distributed under the terms of the Q Public License
+// version 1.0 as appearing in the file LICENSE.QPL included in the
+// packaging of this file.
+
+#include "sys.h"
+#include <cerrno>
+#include <cstring>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include "MappedFile.h"
+#include "exceptions.h"
+#include "debug.h"
+
+MappedFile::MappedFile(std::string const& filename) : M_begin(NULL), M_size(0)
+{
+  int fd = open(filename.c_str(), O_RDONLY);
+  if (fd == -1)
+    THROW_EXCEPTION(std::runtime_error(filename + ": " + strerror(errno)),
+	"MappedFile::MappedFile(\"" << filename << "\"): open failed");
+  struct stat statbuf;
+  if (fstat(fd, &statbuf) == -1)
+  {
+    int saved_errno = errno;
+    close(fd);
+    THROW_EXCEPTION(std::runtime_error("fstat: " + filename + ": " + strerror(saved_errno)),
+	"MappedFile::MappedFile(\"" << filename << "\"): fstat failed");
+  }
+  M_size = statbuf.st_size;
+  // It is not possible to map zero bytes.
+  if (M_size > 0)
+  {
+    void* addr = mmap(NULL, M_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (addr == MAP_FAILED)
+    {
+      int saved_errno = errno;
+      close(fd);
+      THROW_EXCEPTION(std::runtime_error("mmap: " + filename + ": " + strerror(saved_errno)),
+	  "MappedFile::MappedFile(\"" << filename << "\"): mmap of " << M_size << " bytes failed");
+    }
+    M_begin = static_cast<char const*>(addr);
+    // The file is read exactly once from front to back.
+    madvise(addr, M_size, MADV_SEQUENTIAL);
+  }
+  // The mapping stays valid after closing the file descriptor.
+  close(fd);
+}
+
+MappedFile::~MappedFile()
+{
+  if (M_begin)
+    munmap(const_cast<char*>(M_begin), M_size);
+}
@@ -0,0 +1,40 @@
+// cppgraph -- C++ call graph analyzer
+//
+//! @file MappedFile.h
+//! @brief This file contains the declaration of class MappedFile.
+//
+// Copyright (C) 2006, by Timmy <timmy1992@gmail.com>
+//
+// This file may be distributed under the terms of the Q Public License
+// version 1.0 as appearing in the file LICENSE.QPL included in the
+// packaging of this file.
+
+#ifndef MAPPEDFILE_H
+#define MAPPEDFILE_H
+
+#include <string>
+#include <sys/types.h>
+
+// A read-only memory mapping of a whole file.
+//
+// The contents are accessible as the range [begin(), end()), which is NOT
+// zero terminated.  The mapping is released when the object is destructed.
+class MappedFile {
+public:
+  MappedFile(std::string const& filename);	// @throws std::runtime_error
+  ~MappedFile();
+
+  char const* begin(void) const { return M_begin; }
+  char const* end(void) const { return M_begin + M_size; }
+  size_t size(void) const { return M_size; }
+
+private:
+  char const* M_begin;				// Start of the mapping, or NULL when the file is empty.
+  size_t M_size;				// Size of the file.
+
+private:
+  MappedFile(MappedFile const&);		// Not copyable.
+  MappedFile& operator=(MappedFile const&);
+};
+
+#endif // MAPPEDFILE_H
@@ -25,7 +25,7 @@ enum NodeType {
 
 class Node {
 public:
-  Node(void) { }
+  Node(void) : M_index(0) { }
   virtual ~Node() { }
 
   void set_index(size_t index) { M_index = index; }
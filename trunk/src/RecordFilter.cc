@@ -0,0 +1,148 @@
+// cppgraph -- C++ call graph analyzer
+//
+//! @file RecordFilter.cc
+//! @brief This file contains the implementation of class RecordFilter.
+//
+// Copyright (C) 2006, by Timmy <timmy1992@gmail.com>
+//
+// This file may be distributed under the terms of the Q Public License
+// version 1.0 as appearing in the file LICENSE.QPL included in the
+// packaging of this file.
+
+#include "sys.h"
+#include <algorithm>
+#include "RecordFilter.h"
+#include "collapsedpath.h"
+#include "debug.h"
+
+namespace {
+
+// Return true if [str, str_end) matches the glob pattern [pattern, pattern_end).
+bool glob_match(char const* pattern, char const* pattern_end, char const* str, char const* str_end)
+{
+  char const* star = NULL;		// The pattern just after the last '*' seen.
+  char const* star_str = NULL;		// The part of str that was matched with that '*', so far.
+  while (str != str_end)
+  {
+    if (pattern != pattern_end && (*pattern == '?' || *pattern == *str))
+    {
+      ++pattern;
+      ++str;
+    }
+    else if (pattern != pattern_end && *pattern == '*')
+    {
+      star = ++pattern;
+      star_str = str;
+    }
+    else if (star)
+    {
+      // Let the last '*' match one more character.
+      pattern = star;
+      str = ++star_str;
+    }
+    else
+      return false;
+  }
+  while (pattern != pattern_end && *pattern == '*')
+    ++pattern;
+  return pattern == pattern_end;
+}
+
+// A string that is not (necessarily) a std::string.
+struct StringRef {
+  char const* str;
+  size_t len;
+  StringRef(char const* s, size_t l) : str(s), len(l) { }
+};
+
+// Used by std::upper_bound, to compare a StringRef with the elements of a sorted std::vector<std::string>.
+bool operator<(StringRef const& key, std::string const& element)
+{
+  return element.compare(0, element.size(), key.str, key.len) > 0;
+}
+
+} // namespace
+
+void PrefixSet::add(std::string const& prefix)
+{
+  std::vector<std::string>::iterator iter = std::upper_bound(M_prefixes.begin(), M_prefixes.end(), prefix);
+  // Nothing to do if a prefix of 'prefix' is already in the set.
+  if (iter != M_prefixes.begin() && prefix.compare(0, (iter - 1)->size(), *(iter - 1)) == 0)
+    return;
+  // Remove the elements that start with 'prefix'; they are all directly after it.
+  std::vector<std::string>::iterator end = iter;
+  while (end != M_prefixes.end() && end->compare(0, prefix.size(), prefix) == 0)
+    ++end;
+  iter = M_prefixes.erase(iter, end);
+  M_prefixes.insert(iter, prefix);
+}
+
+bool PrefixSet::matches(char const* str, size_t len) const
+{
+  // If a prefix P of str is in the set, then every string between P and str starts with P too,
+  // and therefore can't be in the set: P is the largest element that is not larger than str.
+  std::vector<std::string>::const_iterator iter = std::upper_bound(M_prefixes.begin(), M_prefixes.end(), StringRef(str, len));
+  if (iter == M_prefixes.begin())
+    return false;
+  --iter;
+  return iter->size() <= len && iter->compare(0, iter->size(), str, iter->size()) == 0;
+}
+
+void RecordFilter::exclude_function(std::string const& pattern)
+{
+  std::string::size_type wildcard = pattern.find_first_of("*?");
+  if (wildcard == std::string::npos)
+    M_functions.insert(pattern);
+  else if (wildcard == pattern.size() - 1 && pattern[wildcard] == '*')
+    M_function_prefixes.add(pattern.substr(0, wildcard));
+  else
+    M_function_patterns.push_back(pattern);
+}
+
+void RecordFilter::exclude_file(std::string const& prefix)
+{
+  // The same as FileName does.
+  std::string collapsed = prefix[0] == '/' ? collapsedpath(prefix) : prefix;
+  if (prefix[prefix.size() - 1] == '/' && collapsed[collapsed.size() - 1] != '/')
+    collapsed += '/';
+  M_file_prefixes.add(collapsed);
+}
+
+bool RecordFilter::excludes_function(std::string const& function) const
+{
+  if (!M_function_prefixes.empty() && M_function_prefixes.matches(function.data(), function.size()))
+    return true;
+  if (!M_functions.empty() && M_functions.find(function) != M_functions.end())
+    return true;
+  char const* const begin = function.data();
+  char const* const end = begin + function.size();
+  for (std::vector<std::string>::const_iterator iter = M_function_patterns.begin(); iter != M_function_patterns.end(); ++iter)
+    if (glob_match(iter->data(), iter->data() + iter->size(), begin, end))
+      return true;
+  return false;
+}
+
+bool RecordFilter::excludes_file(std::string const& file, std::string const& curdir) const
+{
+  if (M_file_prefixes.empty())
+    return false;
+  if (CGDRecord::is_relative(file))
+  {
+    std::string absolute(collapsedpath(curdir + "/" + file));
+    return M_file_prefixes.matches(absolute.data(), absolute.size());
+  }
+  // Only collapse paths that need it; most of them don't.
+  if (file[0] == '/' && (file.find("/.") != std::string::npos || file.find("//") != std::string::npos))
+  {
+    std::string collapsed(collapsedpath(file));
+    return M_file_prefixes.matches(collapsed.data(), collapsed.size());
+  }
+  return M_file_prefixes.matches(file.data(), file.size());
+}
+
+bool RecordFilter::excludes(CGDRecord const& record, std::string const& curdir) const
+{
+  if (excludes_function(record.function) || excludes_file(record.file, curdir))
+    return true;
+  return record.type == 'C' && (excludes_function(record.callee) || excludes_file(record.callee_file, curdir));
+}
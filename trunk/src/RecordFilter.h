@@ -0,0 +1,76 @@
+// cppgraph -- C++ call graph analyzer
+//
+//! @file RecordFilter.h
+//! @brief This file contains the declaration of class RecordFilter.
+//
+// Copyright (C) 2006, by Timmy <timmy1992@gmail.com>
+//
+// This file may be distributed under the terms of the Q Public License
+// version 1.0 as appearing in the file LICENSE.QPL included in the
+// packaging of this file.
+
+#ifndef RECORDFILTER_H
+#define RECORDFILTER_H
+
+#include <string>
+#include <vector>
+#include <set>
+#include "CGDRecord.h"
+
+// A set of string prefixes that can be matched with a single binary search.
+class PrefixSet {
+private:
+  std::vector<std::string> M_prefixes;	// Sorted; no element is a prefix of another element.
+
+public:
+  void add(std::string const& prefix);
+  bool empty(void) const { return M_prefixes.empty(); }
+
+  // Return true if one of the prefixes is a prefix of [str, str + len).
+  bool matches(char const* str, size_t len) const;
+};
+
+// Decides which records of the input files are dropped before they are applied,
+// so that no FileName, Function, Location or Edge is ever created for them.
+//
+// A record is excluded when one of its functions (the defined function, or the
+// caller and the callee) matches one of the function patterns, or one of its
+// files (the location, and the file of the callee) starts with one of the file
+// prefixes. Function patterns are matched against the whole function, as it
+// appears in the input file (including return type and parameters); a '*'
+// matches any string and a '?' any character.
+class RecordFilter {
+private:
+  std::set<std::string> M_functions;		// Function patterns without wildcards.
+  PrefixSet M_function_prefixes;		// Function patterns of the form "literal*", without the '*'.
+  std::vector<std::string> M_function_patterns;	// All other function patterns.
+  PrefixSet M_file_prefixes;
+  size_t M_excluded;				// The number of records excluded so far.
+
+public:
+  RecordFilter(void) : M_excluded(0) { }
+
+  // Exclude functions that match 'pattern'.
+  void exclude_function(std::string const& pattern);
+
+  // Exclude files that start with 'prefix'; a trailing '/' is kept.
+  void exclude_file(std::string const& prefix);
+
+  // Return true if there is nothing to exclude.
+  bool empty(void) const
+      { return M_functions.empty() && M_function_prefixes.empty() && M_function_patterns.empty() && M_file_prefixes.empty(); }
+
+  // Return true if 'record' must be dropped. The record must be as returned by CGDRecord::parse_raw;
+  // relative paths are relative to curdir. This function is thread-safe.
+  bool excludes(CGDRecord const& record, std::string const& curdir) const;
+
+  // Count excluded records; only call this from the main thread.
+  void add_excluded(size_t count) { M_excluded += count; }
+  size_t excluded(void) const { return M_excluded; }
+
+private:
+  bool excludes_function(std::string const& function) const;
+  bool excludes_file(std::string const& file, std::string const& curdir) const;
+};
+
+#endif // RECORDFILTER_H
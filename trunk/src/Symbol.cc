@@ -0,0 +1,70 @@
+// cppgraph -- C++ call graph analyzer
+//
+//! @file Symbol.cc
+//! @brief This file contains the implementation of class Symbol.
+//
+// Copyright (C) 2006, by Timmy <timmy1992@gmail.com>
+//
+// This file may be distributed under the terms of the Q Public License
+// version 1.0 as appearing in the file LICENSE.QPL included in the
+// packaging of this file.
+
+#include "sys.h"
+#include <stdexcept>
+#include <cstring>
+#include "Symbol.h"
+#include "content_hash.h"
+#include "exceptions.h"
+#include "debug.h"
+
+std::string* Symbol::S_blocks[S_max_blocks];
+size_t Symbol::S_size;
+size_t Symbol::S_bytes;
+std::vector<Symbol::id_type> Symbol::S_slots;
+std::vector<uint32_t> Symbol::S_hashes;
+
+Symbol::id_type Symbol::intern(char const* str, size_t length)
+{
+  // Keep the load factor at most one half.
+  if (2 * (S_size + 1) > S_slots.size())
+    grow();
+  uint32_t hash = content_hash(str, length);
+  size_t const mask = S_slots.size() - 1;
+  size_t slot = hash & mask;
+  while (S_slots[slot])
+  {
+    id_type id = S_slots[slot] - 1;
+    if (S_hashes[id] == hash)
+    {
+      std::string const& candidate(S_blocks[id >> S_block_bits][id & (S_block_size - 1)]);
+      if (candidate.size() == length && std::memcmp(candidate.data(), str, length) == 0)
+	return id;
+    }
+    slot = (slot + 1) & mask;
+  }
+  if (S_size == S_max_blocks * S_block_size - 1)	// Keep id + 1 from overflowing.
+    THROW_EXCEPTION(std::runtime_error("Too many different names."), "Symbol::intern(): symbol table is full");
+  id_type id = S_size++;
+  std::string*& block(S_blocks[id >> S_block_bits]);
+  if (!block)
+    block = new std::string[S_block_size];
+  block[id & (S_block_size - 1)].assign(str, length);
+  S_bytes += length;
+  S_hashes.push_back(hash);
+  S_slots[slot] = id + 1;
+  return id;
+}
+
+void Symbol::grow(void)
+{
+  std::vector<id_type> slots(S_slots.empty() ? 1024 : 2 * S_slots.size(), 0);
+  size_t const mask = slots.size() - 1;
+  for (id_type id = 0; id < S_size; ++id)
+  {
+    size_t slot = S_hashes[id] & mask;
+    while (slots[slot])
+      slot = (slot + 1) & mask;
+    slots[slot] = id + 1;
+  }
+  S_slots.swap(slots);
+}
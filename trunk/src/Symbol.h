@@ -0,0 +1,94 @@
+// cppgraph -- C++ call graph analyzer
+//
+//! @file Symbol.h
+//! @brief This file contains the declaration of classes Symbol and SymbolIndex.
+//
+// Copyright (C) 2006, by Timmy <timmy1992@gmail.com>
+//
+// This file may be distributed under the terms of the Q Public License
+// version 1.0 as appearing in the file LICENSE.QPL included in the
+// packaging of this file.
+
+#ifndef SYMBOL_H
+#define SYMBOL_H
+
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+// A string that is stored only once, in a process-wide table, and is
+// represented by a 32 bit id: the number of distinct strings that were
+// interned before it.
+//
+// Two symbols are equal if and only if their ids are equal. They are ordered
+// like their strings, so that the order of the containers that are keyed by
+// symbols doesn't change; but only symbols that differ compare their strings.
+//
+// New symbols may only be created by the main thread. The string of a symbol
+// never moves, so str() may be called by any thread that got the symbol from
+// the main thread.
+class Symbol {
+public:
+  typedef uint32_t id_type;
+
+  // Intern 'str'.
+  explicit Symbol(std::string const& str) : M_id(intern(str.data(), str.size())) { }
+  // Intern the 'length' characters at 'str'.
+  Symbol(char const* str, size_t length) : M_id(intern(str, length)) { }
+  // The empty string.
+  Symbol(void) : M_id(intern("", 0)) { }
+
+  id_type id(void) const { return M_id; }
+  std::string const& str(void) const { return S_blocks[M_id >> S_block_bits][M_id & (S_block_size - 1)]; }
+
+  friend bool operator==(Symbol s1, Symbol s2) { return s1.M_id == s2.M_id; }
+  friend bool operator!=(Symbol s1, Symbol s2) { return s1.M_id != s2.M_id; }
+  friend bool operator<(Symbol s1, Symbol s2) { return s1.M_id != s2.M_id && s1.str() < s2.str(); }
+
+  // The number of distinct strings interned so far, and their total size in bytes.
+  static size_t size(void) { return S_size; }
+  static size_t bytes(void) { return S_bytes; }
+
+private:
+  id_type M_id;
+
+  // The strings are stored in blocks that are never reallocated.
+  static unsigned int const S_block_bits = 14;
+  static size_t const S_block_size = 1 << S_block_bits;
+  static size_t const S_max_blocks = 1 << (32 - S_block_bits);
+  static std::string* S_blocks[S_max_blocks];
+  static size_t S_size;
+  static size_t S_bytes;
+  // Open addressing hash table of id + 1 (0 is an empty slot), and the hash of every string.
+  static std::vector<id_type> S_slots;
+  static std::vector<uint32_t> S_hashes;
+
+  static id_type intern(char const* str, size_t length);
+  static void grow(void);
+};
+
+// Finds the element of a container that is keyed by a given symbol without
+// comparing strings. Only one element is remembered per symbol.
+template<class T>
+class SymbolIndex {
+private:
+  std::vector<T const*> M_elements;	// Indexed by symbol id.
+
+public:
+  T const* find(Symbol symbol) const
+      { return symbol.id() < M_elements.size() ? M_elements[symbol.id()] : NULL; }
+  void insert(Symbol symbol, T const& element)
+  {
+    if (symbol.id() >= M_elements.size())
+      M_elements.resize(symbol.id() + 1, NULL);
+    M_elements[symbol.id()] = &element;
+  }
+  // Forget 'element', which is about to be erased from its container.
+  void erase(Symbol symbol, T const& element)
+  {
+    if (find(symbol) == &element)
+      M_elements[symbol.id()] = NULL;
+  }
+};
+
+#endif // SYMBOL_H
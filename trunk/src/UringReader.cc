@@ -0,0 +1,454 @@
+// cppgraph -- C++ call graph analyzer
+//
+//! @file UringReader.cc
+//! @brief This file contains the implementation of the io_uring input reader.
+//
+// Copyright (C) 2006, by Timmy <timmy1992@gmail.com>
+//
+// This file may be distributed under the terms of the Q Public License
+// version 1.0 as appearing in the file LICENSE.QPL included in the
+// packaging of this file.
+
+#include "sys.h"
+#include "UringReader.h"
+
+#ifndef HAVE_IO_URING
+
+InputReader* create_uring_reader(std::vector<std::string const*> const&)
+{
+  return NULL;
+}
+
+#else // HAVE_IO_URING
+
+#include <cerrno>
+#include <cstring>
+#include <cstdlib>
+#include <algorithm>
+#include <stdexcept>
+#include <sys/types.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <linux/io_uring.h>
+#include "exceptions.h"
+#include "debug.h"
+
+namespace {
+
+// There is no libc wrapper for these system calls.
+int io_uring_setup(unsigned int entries, struct io_uring_params* params)
+{
+  return syscall(__NR_io_uring_setup, entries, params);
+}
+
+int io_uring_enter(int ring_fd, unsigned int to_submit, unsigned int min_complete, unsigned int flags)
+{
+  return syscall(__NR_io_uring_enter, ring_fd, to_submit, min_complete, flags, NULL, 0);
+}
+
+int io_uring_register(int ring_fd, unsigned int opcode, void* arg, unsigned int nr_args)
+{
+  return syscall(__NR_io_uring_register, ring_fd, opcode, arg, nr_args);
+}
+
+// The operations of the state machine of a single file: open -> read (repeated until EOF) -> close.
+enum uring_op_type { op_open, op_read, op_close };
+
+class UringReader : public InputReader {
+private:
+  static unsigned int const S_ring_entries = 256;	// Size of the submission queue.
+  static size_t const S_max_active = 64;		// Maximum number of files being opened or read at the same time.
+  static size_t const S_max_ahead = 256;		// Maximum number of files read, but not yet released.
+  static size_t const S_initial_buffer_size = 16384;	// Most .cgd files are smaller than this.
+
+  // The state of one file.
+  struct Slot {
+    char* buffer;
+    size_t capacity;
+    size_t size;			// Number of bytes read so far.
+    int fd;
+    int error;				// Set to an errno value when open or read failed.
+    char const* failed_call;		// The name of the call that failed.
+    bool done;				// Set when the file was read completely, or failed.
+    Slot(void) : buffer(NULL), capacity(0), size(0), fd(-1), error(0), failed_call(NULL), done(false) { }
+  };
+
+  std::vector<std::string const*> const& M_filenames;
+  std::vector<Slot> M_slots;
+
+  // The ring.
+  int M_ring_fd;
+  void* M_sq_ring;
+  size_t M_sq_ring_size;
+  void* M_cq_ring;
+  size_t M_cq_ring_size;
+  struct io_uring_sqe* M_sqes;
+  size_t M_sqes_size;
+  unsigned int* M_sq_tail;
+  unsigned int M_sq_mask;
+  unsigned int* M_sq_array;
+  unsigned int* M_cq_head;
+  unsigned int* M_cq_tail;
+  unsigned int M_cq_mask;
+  struct io_uring_cqe* M_cqes;
+
+  // Only used by the ring thread.
+  unsigned int M_to_submit;		// Number of prepared, but not yet submitted, requests.
+  unsigned int M_outstanding;		// Number of prepared requests whose completion wasn't reaped yet.
+  size_t M_active;			// Number of files being opened or read.
+  size_t M_next;			// Index of the next file that should be opened.
+  bool M_draining;			// Set when we're stopping; just close everything.
+
+  // Shared between the ring thread and the callers of get and release.
+  pthread_t M_thread;
+  pthread_mutex_t M_mutex;
+  pthread_cond_t M_cond;
+  size_t M_released;			// Number of files released so far.
+  bool M_stop;				// Set by the destructor.
+
+public:
+  UringReader(std::vector<std::string const*> const& filenames);
+  ~UringReader();
+
+  // Set up the ring and start the ring thread. Returns false if io_uring can't be used.
+  bool start(void);
+
+  virtual void get(size_t index, char const*& begin, size_t& size);
+  virtual void release(size_t index);
+  virtual char const* name(void) const { return "io_uring"; }
+
+private:
+  static void* thread_main(void* arg);
+  void run(void);
+  void prep(uring_op_type op, size_t index);
+  void complete(struct io_uring_cqe const* cqe);
+  void finish(size_t index, int error, char const* failed_call);
+};
+
+UringReader::UringReader(std::vector<std::string const*> const& filenames) :
+    M_filenames(filenames), M_slots(filenames.size()), M_ring_fd(-1), M_sq_ring(MAP_FAILED), M_cq_ring(MAP_FAILED),
+    M_sqes(static_cast<struct io_uring_sqe*>(MAP_FAILED)), M_to_submit(0), M_outstanding(0), M_active(0), M_next(0),
+    M_draining(false), M_released(0), M_stop(false)
+{
+  pthread_mutex_init(&M_mutex, NULL);
+  pthread_cond_init(&M_cond, NULL);
+}
+
+bool UringReader::start(void)
+{
+  struct io_uring_params params;
+  memset(&params, 0, sizeof(params));
+  M_ring_fd = io_uring_setup(S_ring_entries, &params);
+  if (M_ring_fd == -1)
+  {
+    Dout(dc::notice|error_cf, "io_uring_setup");
+    return false;
+  }
+
+  // Make sure the kernel supports all operations that we need (opening files asynchronously needs linux 5.6).
+  size_t probe_size = sizeof(struct io_uring_probe) + 256 * sizeof(struct io_uring_probe_op);
+  struct io_uring_probe* probe = static_cast<struct io_uring_probe*>(calloc(1, probe_size));
+  bool supported = io_uring_register(M_ring_fd, IORING_REGISTER_PROBE, probe, 256) == 0;
+  int const needed_ops[] = { IORING_OP_OPENAT, IORING_OP_READ, IORING_OP_CLOSE };
+  for (size_t i = 0; supported && i < sizeof(needed_ops) / sizeof(int); ++i)
+    supported = needed_ops[i] <= probe->last_op && (probe->ops[needed_ops[i]].flags & IO_URING_OP_SUPPORTED);
+  free(probe);
+  if (!supported)
+  {
+    Dout(dc::notice, "io_uring does not support IORING_OP_OPENAT, IORING_OP_READ and IORING_OP_CLOSE.");
+    return false;
+  }
+
+  M_sq_ring_size = params.sq_off.array + params.sq_entries * sizeof(unsigned int);
+  M_cq_ring_size = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+  if ((params.features & IORING_FEAT_SINGLE_MMAP))
+    M_sq_ring_size = M_cq_ring_size = std::max(M_sq_ring_size, M_cq_ring_size);
+  M_sq_ring = mmap(NULL, M_sq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, M_ring_fd, IORING_OFF_SQ_RING);
+  if (M_sq_ring == MAP_FAILED)
+  {
+    Dout(dc::notice|error_cf, "mmap");
+    return false;
+  }
+  if ((params.features & IORING_FEAT_SINGLE_MMAP))
+    M_cq_ring = M_sq_ring;
+  else
+  {
+    M_cq_ring = mmap(NULL, M_cq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, M_ring_fd, IORING_OFF_CQ_RING);
+    if (M_cq_ring == MAP_FAILED)
+    {
+      Dout(dc::notice|error_cf, "mmap");
+      return false;
+    }
+  }
+  M_sqes_size = params.sq_entries * sizeof(struct io_uring_sqe);
+  M_sqes = static_cast<struct io_uring_sqe*>(
+      mmap(NULL, M_sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, M_ring_fd, IORING_OFF_SQES));
+  if (M_sqes == MAP_FAILED)
+  {
+    Dout(dc::notice|error_cf, "mmap");
+    return false;
+  }
+
+  char* sq_ring = static_cast<char*>(M_sq_ring);
+  char* cq_ring = static_cast<char*>(M_cq_ring);
+  M_sq_tail = reinterpret_cast<unsigned int*>(sq_ring + params.sq_off.tail);
+  M_sq_mask = *reinterpret_cast<unsigned int*>(sq_ring + params.sq_off.ring_mask);
+  M_sq_array = reinterpret_cast<unsigned int*>(sq_ring + params.sq_off.array);
+  M_cq_head = reinterpret_cast<unsigned int*>(cq_ring + params.cq_off.head);
+  M_cq_tail = reinterpret_cast<unsigned int*>(cq_ring + params.cq_off.tail);
+  M_cq_mask = *reinterpret_cast<unsigned int*>(cq_ring + params.cq_off.ring_mask);
+  M_cqes = reinterpret_cast<struct io_uring_cqe*>(cq_ring + params.cq_off.cqes);
+
+  if (pthread_create(&M_thread, NULL, thread_main, this) != 0)
+    DoutFatal(dc::fatal|error_cf, "pthread_create");
+  return true;
+}
+
+UringReader::~UringReader()
+{
+  if (M_sqes != MAP_FAILED)
+  {
+    // Stop the ring thread; it won't return before all requests completed.
+    pthread_mutex_lock(&M_mutex);
+    M_stop = true;
+    pthread_cond_broadcast(&M_cond);
+    pthread_mutex_unlock(&M_mutex);
+    pthread_join(M_thread, NULL);
+    munmap(M_sqes, M_sqes_size);
+  }
+  if (M_cq_ring != MAP_FAILED && M_cq_ring != M_sq_ring)
+    munmap(M_cq_ring, M_cq_ring_size);
+  if (M_sq_ring != MAP_FAILED)
+    munmap(M_sq_ring, M_sq_ring_size);
+  if (M_ring_fd != -1)
+    close(M_ring_fd);
+  for (std::vector<Slot>::iterator iter = M_slots.begin(); iter != M_slots.end(); ++iter)
+    free(iter->buffer);
+  pthread_cond_destroy(&M_cond);
+  pthread_mutex_destroy(&M_mutex);
+}
+
+void UringReader::get(size_t index, char const*& begin, size_t& size)
+{
+  Slot& slot(M_slots[index]);
+  pthread_mutex_lock(&M_mutex);
+  while (!slot.done)
+    pthread_cond_wait(&M_cond, &M_mutex);
+  pthread_mutex_unlock(&M_mutex);
+  if (slot.error)
+  {
+    std::string const& filename(*M_filenames[index]);
+    if (!strcmp(slot.failed_call, "open"))
+      THROW_EXCEPTION(std::runtime_error(filename + ": " + strerror(slot.error)),
+	  "UringReader::get(" << index << "): open failed");
+    THROW_EXCEPTION(std::runtime_error(std::string(slot.failed_call) + ": " + filename + ": " + strerror(slot.error)),
+	"UringReader::get(" << index << "): " << slot.failed_call << " failed");
+  }
+  begin = slot.buffer;
+  size = slot.size;
+}
+
+void UringReader::release(size_t index)
+{
+  Slot& slot(M_slots[index]);
+  free(slot.buffer);
+  slot.buffer = NULL;
+  pthread_mutex_lock(&M_mutex);
+  ++M_released;
+  pthread_cond_broadcast(&M_cond);
+  pthread_mutex_unlock(&M_mutex);
+}
+
+void* UringReader::thread_main(void* arg)
+{
+  Debug(debug::init_thread());
+  static_cast<UringReader*>(arg)->run();
+  return NULL;
+}
+
+// Add a request for operation 'op' on file number 'index' to the submission queue.
+void UringReader::prep(uring_op_type op, size_t index)
+{
+  Slot& slot(M_slots[index]);
+  unsigned int tail = *M_sq_tail;
+  unsigned int sqe_index = tail & M_sq_mask;
+  struct io_uring_sqe* sqe = &M_sqes[sqe_index];
+  memset(sqe, 0, sizeof(*sqe));
+  switch (op)
+  {
+    case op_open:
+      sqe->opcode = IORING_OP_OPENAT;
+      sqe->fd = AT_FDCWD;
+      sqe->addr = reinterpret_cast<unsigned long>(M_filenames[index]->c_str());
+      sqe->open_flags = O_RDONLY;
+      break;
+    case op_read:
+      sqe->opcode = IORING_OP_READ;
+      sqe->fd = slot.fd;
+      sqe->addr = reinterpret_cast<unsigned long>(slot.buffer + slot.size);
+      sqe->len = slot.capacity - slot.size;
+      sqe->off = slot.size;
+      break;
+    case op_close:
+      sqe->opcode = IORING_OP_CLOSE;
+      sqe->fd = slot.fd;
+      slot.fd = -1;
+      break;
+  }
+  sqe->user_data = (static_cast<unsigned long long>(index) << 2) | op;
+  M_sq_array[sqe_index] = sqe_index;
+  // The kernel may only see the new tail after the entry was written.
+  __sync_synchronize();
+  *M_sq_tail = tail + 1;
+  ++M_to_submit;
+  ++M_outstanding;
+}
+
+// Mark file number 'index' as done and wake up get().
+void UringReader::finish(size_t index, int error, char const* failed_call)
+{
+  Slot& slot(M_slots[index]);
+  slot.error = error;
+  slot.failed_call = failed_call;
+  --M_active;
+  pthread_mutex_lock(&M_mutex);
+  slot.done = true;
+  pthread_cond_broadcast(&M_cond);
+  pthread_mutex_unlock(&M_mutex);
+}
+
+// Handle a completion: advance the state machine of the file that it belongs to.
+void UringReader::complete(struct io_uring_cqe const* cqe)
+{
+  size_t index = cqe->user_data >> 2;
+  uring_op_type op = static_cast<uring_op_type>(cqe->user_data & 3);
+  int res = cqe->res;
+  Slot& slot(M_slots[index]);
+  --M_outstanding;
+  switch (op)
+  {
+    case op_open:
+      if (res < 0)
+      {
+	finish(index, -res, "open");
+	break;
+      }
+      slot.fd = res;
+      if (M_draining)
+      {
+	prep(op_close, index);
+	finish(index, ECANCELED, "read");
+	break;
+      }
+      slot.capacity = S_initial_buffer_size;
+      slot.buffer = static_cast<char*>(malloc(slot.capacity));
+      prep(op_read, index);
+      break;
+    case op_read:
+      if (res < 0 && res != -EINTR && res != -EAGAIN)
+      {
+	prep(op_close, index);
+	finish(index, -res, "read");
+	break;
+      }
+      if (res > 0)
+	slot.size += res;
+      if (res != 0 && slot.size == slot.capacity && !M_draining)
+      {
+	// The buffer is full; there might be more.
+	slot.capacity *= 2;
+	slot.buffer = static_cast<char*>(realloc(slot.buffer, slot.capacity));
+	prep(op_read, index);
+	break;
+      }
+      if (res < 0 && !M_draining)
+      {
+	prep(op_read, index);		// Interrupted: try again.
+	break;
+      }
+      // A short read means that we reached the end of the file.
+      prep(op_close, index);
+      finish(index, M_draining ? ECANCELED : 0, "read");
+      break;
+    case op_close:
+      break;
+  }
+}
+
+void UringReader::run(void)
+{
+  size_t const number_of_files = M_filenames.size();
+  for(;;)
+  {
+    pthread_mutex_lock(&M_mutex);
+    size_t released = M_released;
+    if (M_stop)
+      M_draining = true;
+    pthread_mutex_unlock(&M_mutex);
+
+    // Keep the queue filled. Reaping a completion never adds more than one new request,
+    // so the submission queue can't overflow as long as M_outstanding <= S_ring_entries.
+    if (!M_draining)
+      while (M_active < S_max_active && M_outstanding < S_ring_entries &&
+	     M_next < number_of_files && M_next < released + S_max_ahead)
+      {
+	++M_active;
+	prep(op_open, M_next++);
+      }
+
+    if (M_outstanding == 0)
+    {
+      if (M_draining || M_next == number_of_files)
+	break;
+      // Wait until the consumer released some files.
+      pthread_mutex_lock(&M_mutex);
+      while (!M_stop && M_released == released)
+	pthread_cond_wait(&M_cond, &M_mutex);
+      pthread_mutex_unlock(&M_mutex);
+      continue;
+    }
+
+    // Submit the new requests and wait for at least one completion.
+    int submitted = io_uring_enter(M_ring_fd, M_to_submit, 1, IORING_ENTER_GETEVENTS);
+    if (submitted == -1)
+    {
+      if (errno != EINTR && errno != EAGAIN && errno != EBUSY)
+	DoutFatal(dc::fatal|error_cf, "io_uring_enter");
+    }
+    else
+      M_to_submit -= submitted;
+
+    // Reap all completions.
+    unsigned int head = *M_cq_head;
+    for(;;)
+    {
+      unsigned int tail = *M_cq_tail;
+      // Don't read the entries before the tail.
+      __sync_synchronize();
+      if (head == tail)
+	break;
+      while (head != tail)
+	complete(&M_cqes[head++ & M_cq_mask]);
+      *M_cq_head = head;
+    }
+    __sync_synchronize();
+  }
+}
+
+} // namespace
+
+InputReader* create_uring_reader(std::vector<std::string const*> const& filenames)
+{
+  UringReader* reader = new UringReader(filenames);
+  if (!reader->start())
+  {
+    delete reader;
+    return NULL;
+  }
+  return reader;
+}
+
+#endif // HAVE_IO_URING
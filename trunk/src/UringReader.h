@@ -0,0 +1,22 @@
+// cppgraph -- C++ call graph analyzer
+//
+//! @file UringReader.h
+//! @brief This file contains the declaration of function create_uring_reader.
+//
+// Copyright (C) 2006, by Timmy <timmy1992@gmail.com>
+//
+// This file may be distributed under the terms of the Q Public License
+// version 1.0 as appearing in the file LICENSE.QPL included in the
+// packaging of this file.
+
+#ifndef URINGREADER_H
+#define URINGREADER_H
+
+#include "InputReader.h"
+
+// Create a reader that keeps a deep queue of asynchronous open/read/close
+// requests in flight, using Linux io_uring.  Returns NULL when io_uring
+// is not supported by this build, by the kernel, or is not permitted.
+InputReader* create_uring_reader(std::vector<std::string const*> const& filenames);
+
+#endif // URINGREADER_H
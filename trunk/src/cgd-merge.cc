@@ -0,0 +1,161 @@
+// cppgraph -- C++ call graph analyzer
+//
+//! @file cgd-merge.cc
+//! @brief This file contains the program that merges .cgd files into a corpus.
+//
+// Copyright (C) 2006, by Timmy <timmy1992@gmail.com>
+//
+// This file may be distributed under the terms of the Q Public License
+// version 1.0 as appearing in the file LICENSE.QPL included in the
+// packaging of this file.
+
+#include "sys.h"
+#include <iostream>
+#include <vector>
+#include <string>
+#include <getopt.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include "realpath.h"
+#include "MappedFile.h"
+#include "CGDCorpus.h"
+#include "exceptions.h"
+#include "debug.h"
+
+int const exit_code_success = 0;
+int const error_unknown_option = 2;	// Unknown command line option.
+int const error_no_input = 3;		// No input files given.
+int const error_runtime_exception = 4;	// Program caught runtime-error exception.
+
+namespace {
+
+// Return the full path of 'filename', with the symbolic links of its directory resolved.
+std::string full_path(std::string const& filename)
+{
+  std::string::size_type slash = filename.rfind('/');
+  if (slash == std::string::npos)
+    return realpath(".") + '/' + filename;
+  if (slash == 0)
+    return filename;
+  return realpath(filename.substr(0, slash)) + filename.substr(slash);
+}
+
+} // namespace
+
+int main(int argc, char* const argv[])
+{
+  Debug(debug::init());
+
+  // Make a copy of this.
+  std::string program_name(argv[0]);
+
+  // Parse command line arguments.
+  bool print_usage = false;
+  int verbose = 0;
+  int exit_code = exit_code_success;
+  std::string output_file;
+  std::vector<std::string> remove_files;
+
+  while (1)
+  {
+    int option_index = 0;
+    static struct option long_options[] = {
+      { "output", 1, 0, 'o' },
+      { "remove", 1, 0, 'r' },
+      { "verbose", 0, 0, 'v' },
+      { "help", 0, 0, 'h' },
+      { 0, 0, 0, 0 }
+    };
+
+    int c = getopt_long(argc, argv, "ho:r:v", long_options, &option_index);
+    if (c == -1)
+      break;
+
+    switch (c)
+    {
+      case 'o':
+        output_file = optarg;
+	break;
+      case 'r':
+        remove_files.push_back(optarg);
+	break;
+      case 'v':
+        ++verbose;
+	break;
+      case 'h':
+        print_usage = true;
+        break;
+      case '?':
+        print_usage = true;
+	exit_code = error_unknown_option;
+        break;
+      default:
+        std::cerr << "?? getopt returned character code " << c << " ??\n";
+    }
+  }
+
+  std::vector<std::string> input_files(argv + optind, argv + argc);
+  if (!print_usage && exit_code == 0)
+  {
+    if (output_file.empty())
+    {
+      std::cerr << program_name << ": --output is required." << std::endl;
+      exit_code = error_unknown_option;
+    }
+    else if (input_files.empty() && remove_files.empty())
+    {
+      print_usage = true;
+      exit_code = error_no_input;
+    }
+  }
+
+  if (print_usage)
+  {
+    std::ostream* out = (exit_code == 0) ? &std::cout : &std::cerr;
+    *out << "Usage: " << program_name << " [options] --output <corpus.cgdm> <file.cgd>..." << std::endl;
+    *out << "Options:\n";
+    *out << "\t--help, -h\t\t\tPrint this help and exit successfully.\n";
+    *out << "\t--output, -o <file>\t\tThe corpus to create, or to update if it exists.\n";
+    *out << "\t--remove, -r <file.cgd>\t\tRemove a compilation unit from the corpus.\n";
+    *out << "\t--verbose, -v\t\t\tPrint the size of the corpus.\n";
+    *out << "\nMerges \".cgd\" files into a \".cgdm\" corpus, that contains every distinct record\n";
+    *out << "only once. genfull reads a corpus instead of the \".cgd\" files that it contains.\n";
+    *out << "Adding a \".cgd\" file that is already part of the corpus replaces its records." << std::endl;
+  }
+
+  if (print_usage || exit_code != 0)
+    return exit_code;
+
+  try
+  {
+    CGDCorpus corpus;
+    struct stat statbuf;
+    if (stat(output_file.c_str(), &statbuf) == 0)
+      corpus.read(output_file);
+    for (std::vector<std::string>::iterator iter = remove_files.begin(); iter != remove_files.end(); ++iter)
+      if (!corpus.remove(full_path(*iter)))
+	std::cerr << "WARNING: " << *iter << " is not part of " << output_file << '.' << std::endl;
+    for (std::vector<std::string>::iterator iter = input_files.begin(); iter != input_files.end(); ++iter)
+    {
+      MappedFile input(*iter);
+      corpus.add(full_path(*iter), input.begin(), input.end());
+    }
+    corpus.write(output_file);
+    if (verbose)
+    {
+      size_t size = stat(output_file.c_str(), &statbuf) == 0 ? statbuf.st_size : 0;
+      std::cout << output_file << ": " << corpus.units() << " compilation units, " <<
+	  corpus.records() << " records, " << size << " bytes." << std::endl;
+    }
+  }
+  catch (std::runtime_error const& error)
+  {
+    Debug(edragon::caught(error));
+    std::cerr << program_name << ": " << error.what() << std::endl;
+    exit_code = error_runtime_exception;
+  }
+
+  // Flush all remaining debug output.
+  Dout(dc::always|noprefix_cf|nonewline_cf|flush_cf, "");
+  return exit_code;
+}
@@ -0,0 +1,179 @@
+// cppgraph -- C++ call graph analyzer
+//
+//! @file cgd2bin.cc
+//! @brief This file contains the converter from .cgd files to .cgdb files.
+//
+// Copyright (C) 2006, by Timmy <timmy1992@gmail.com>
+//
+// This file may be distributed under the terms of the Q Public License
+// version 1.0 as appearing in the file LICENSE.QPL included in the
+// packaging of this file.
+
+#include "sys.h"
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <string>
+#include <cstring>
+#include <getopt.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include "realpath.h"
+#include "MappedFile.h"
+#include "CGDRecord.h"
+#include "CGDBinary.h"
+#include "exceptions.h"
+#include "debug.h"
+
+int const exit_code_success = 0;
+int const error_unknown_option = 2;	// Unknown command line option.
+int const error_no_input = 3;		// No input files given.
+int const error_runtime_exception = 4;	// Program caught runtime-error exception.
+
+namespace {
+
+// Convert input_file to output_file. Returns the size of the output file.
+size_t convert(std::string const& input_file, std::string const& output_file)
+{
+  // Relative paths in the .cgd file are relative to the directory that contains it. Like genfull,
+  // use that directory as it appears in the path of the input file: resolving symbolic links
+  // would give the paths in the .cgdb file different FileNames than those in the .cgd file.
+  std::string path(input_file);
+  if (path[0] != '/')
+    path = realpath(".") + '/' + path;
+  std::string curdir(path, 0, path.rfind('/'));
+  MappedFile input(input_file);
+  CGDBinaryWriter writer;
+  CGDRecord record;
+  int line_nr = 0;
+  char const* const end = input.end();
+  for (char const* line = input.begin(); line < end;)
+  {
+    char const* eol = static_cast<char const*>(memchr(line, '\n', end - line));
+    if (!eol)
+      eol = end;
+    record.parse_raw(line, eol - line, input_file, ++line_nr);
+    writer.add(record, curdir);
+    line = eol + 1;
+  }
+  writer.write(output_file);
+  struct stat statbuf;
+  return stat(output_file.c_str(), &statbuf) == 0 ? statbuf.st_size : 0;
+}
+
+} // namespace
+
+int main(int argc, char* const argv[])
+{
+  Debug(debug::init());
+
+  // Make a copy of this.
+  std::string program_name(argv[0]);
+
+  // Parse command line arguments.
+  bool print_usage = false;
+  int verbose = 0;
+  int exit_code = exit_code_success;
+  std::string output_file;
+
+  while (1)
+  {
+    int option_index = 0;
+    static struct option long_options[] = {
+      { "output", 1, 0, 'o' },
+      { "verbose", 0, 0, 'v' },
+      { "help", 0, 0, 'h' },
+      { 0, 0, 0, 0 }
+    };
+
+    int c = getopt_long(argc, argv, "ho:v", long_options, &option_index);
+    if (c == -1)
+      break;
+
+    switch (c)
+    {
+      case 'o':
+        output_file = optarg;
+	break;
+      case 'v':
+        ++verbose;
+	break;
+      case 'h':
+        print_usage = true;
+        break;
+      case '?':
+        print_usage = true;
+	exit_code = error_unknown_option;
+        break;
+      default:
+        std::cerr << "?? getopt returned character code " << c << " ??\n";
+    }
+  }
+
+  std::vector<std::string> input_files(argv + optind, argv + argc);
+  if (!print_usage && exit_code == 0)
+  {
+    if (input_files.empty())
+    {
+      print_usage = true;
+      exit_code = error_no_input;
+    }
+    else if (!output_file.empty() && input_files.size() > 1)
+    {
+      std::cerr << program_name << ": --output can only be used with a single input file." << std::endl;
+      exit_code = error_unknown_option;
+    }
+  }
+
+  if (print_usage)
+  {
+    std::ostream* out = (exit_code == 0) ? &std::cout : &std::cerr;
+    *out << "Usage: " << program_name << " [options] <file.cgd>..." << std::endl;
+    *out << "Options:\n";
+    *out << "\t--help, -h\t\t\tPrint this help and exit successfully.\n";
+    *out << "\t--output, -o <file>\t\tThe output file [default: the input file with the suffix \".cgdb\"].\n";
+    *out << "\t--verbose, -v\t\t\tPrint the size of every converted file.\n";
+    *out << "\nConverts \".cgd\" files into the binary \".cgdb\" format, that genfull reads\n";
+    *out << "instead of a \".cgd\" file with the same name, unless the latter is newer." << std::endl;
+  }
+
+  if (print_usage || exit_code != 0)
+    return exit_code;
+
+  try
+  {
+    for (std::vector<std::string>::iterator iter = input_files.begin(); iter != input_files.end(); ++iter)
+    {
+      std::string output(output_file);
+      if (output.empty())
+      {
+	size_t len = iter->size();
+	output = (len >= 4 && !iter->compare(len - 4, 4, ".cgd")) ? *iter + 'b' : *iter + ".cgdb";
+      }
+      size_t size = convert(*iter, output);
+      if (verbose)
+      {
+	struct stat statbuf;
+	size_t input_size = stat(iter->c_str(), &statbuf) == 0 ? statbuf.st_size : 0;
+	std::ios::fmtflags flags = std::cout.flags();
+	std::streamsize precision = std::cout.precision();
+	std::cout << *iter << " -> " << output << ": " << input_size << " -> " << size << " bytes";
+	if (size > 0)
+	  std::cout << " (" << std::fixed << std::setprecision(1) << (double)input_size / size << "x smaller)";
+	std::cout << std::endl;
+	std::cout.flags(flags);
+	std::cout.precision(precision);
+      }
+    }
+  }
+  catch (std::runtime_error const& error)
+  {
+    Debug(edragon::caught(error));
+    std::cerr << program_name << ": " << error.what() << std::endl;
+    exit_code = error_runtime_exception;
+  }
+
+  // Flush all remaining debug output.
+  Dout(dc::always|noprefix_cf|nonewline_cf|flush_cf, "");
+  return exit_code;
+}
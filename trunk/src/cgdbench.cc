@@ -0,0 +1,326 @@
+// cppgraph -- C++ call graph analyzer
+//
+//! @file cgdbench.cc
+//! @brief This file contains a benchmark of the different ways to read and tokenize the .cgd files.
+//
+// Copyright (C) 2006, by Timmy <timmy1992@gmail.com>
+//
+// This file may be distributed under the terms of the Q Public License
+// version 1.0 as appearing in the file LICENSE.QPL included in the
+// packaging of this file.
+
+#include "sys.h"
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <string>
+#include <cstring>
+#include <cstdlib>
+#include <memory>
+#include <getopt.h>
+#include <sys/types.h>
+#include <sys/time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include "Subdir.h"
+#include "CGDFile.h"
+#include "InputReader.h"
+#include "MappedFile.h"
+#include "CGDRecord.h"
+#include "exceptions.h"
+#include "debug.h"
+
+int const exit_code_success = 0;
+int const error_unknown_option = 2;	// Unknown command line option.
+int const error_no_input = 3;		// No input files found.
+int const error_runtime_exception = 4;	// Program caught runtime-error exception.
+
+namespace {
+
+// Evict the input files from the page cache, so that the next read has to go to the disk.
+// This only works for pages that are not dirty, and doesn't need root privileges.
+void drop_page_cache(std::vector<std::string const*> const& filenames)
+{
+  for (std::vector<std::string const*>::const_iterator iter = filenames.begin(); iter != filenames.end(); ++iter)
+  {
+    int fd = open((*iter)->c_str(), O_RDONLY);
+    if (fd == -1)
+      continue;
+    posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+    close(fd);
+  }
+}
+
+// The result of reading all input files once.
+struct Result {
+  double seconds;
+  double bytes;
+  size_t lines;
+};
+
+// Read all input files with 'io_backend' and count the lines, like the record parser would see them.
+Result read_all(io_backend_type io_backend, std::vector<std::string const*> const& filenames, std::string& backend_name)
+{
+  Result result;
+  result.bytes = 0;
+  result.lines = 0;
+  struct timeval start;
+  gettimeofday(&start, NULL);
+  std::auto_ptr<InputReader> reader(create_input_reader(io_backend, filenames));
+  backend_name = reader->name();
+  for (size_t index = 0; index < filenames.size(); ++index)
+  {
+    char const* begin;
+    size_t size;
+    reader->get(index, begin, size);
+    char const* const end = begin + size;
+    for (char const* eol = begin; (eol = static_cast<char const*>(memchr(eol, '\n', end - eol))); ++eol)
+      ++result.lines;
+    result.bytes += size;
+    reader->release(index);
+  }
+  reader.reset();
+  struct timeval stop;
+  gettimeofday(&stop, NULL);
+  result.seconds = (stop.tv_sec - start.tv_sec) + (stop.tv_usec - start.tv_usec) * 1e-6;
+  return result;
+}
+
+// Print the fastest of 'repeat' runs of read_all with every input backend, with a cold and a warm page cache.
+void benchmark_backends(int repeat)
+{
+  std::vector<CGDFile::container_type::iterator> input_files;
+  get_input_files(input_files);
+  std::vector<std::string const*> filenames;
+  for (std::vector<CGDFile::container_type::iterator>::iterator iter = input_files.begin(); iter != input_files.end(); ++iter)
+    filenames.push_back(&(*iter)->input_file());
+
+  io_backend_type const backends[] = { io_backend_mmap, io_backend_pread, io_backend_uring };
+  std::cout << "Backend   Cache  Files     MB      Seconds  MB/s      Files/s\n";
+  std::cout << std::fixed;
+  for (size_t b = 0; b < sizeof(backends) / sizeof(io_backend_type); ++b)
+  {
+    for (int warm = 0; warm <= 1; ++warm)
+    {
+      Result best = Result();
+      std::string backend_name;
+      if (warm)
+	read_all(backends[b], filenames, backend_name);	// Fill the page cache.
+      for (int run = 0; run < repeat; ++run)
+      {
+	if (!warm)
+	  drop_page_cache(filenames);
+	Result result = read_all(backends[b], filenames, backend_name);
+	if (run == 0 || result.seconds < best.seconds)
+	  best = result;
+      }
+      std::cout << std::left << std::setw(10) << backend_name << std::setw(7) << (warm ? "warm" : "cold") <<
+	  std::setw(10) << filenames.size() << std::setprecision(1) << std::setw(8) << best.bytes / 1048576.0 <<
+	  std::setprecision(4) << std::setw(9) << best.seconds << std::setprecision(1) << std::setw(10);
+      if (best.seconds > 0)
+	std::cout << best.bytes / 1048576.0 / best.seconds << filenames.size() / best.seconds;
+      else
+	std::cout << "-" << "-";
+      std::cout << std::endl;
+    }
+  }
+}
+
+// Parse all records of the text input files, that were read into 'contents', with the current
+// tokenizer of CGDRecord, and rewrite their anonymous namespaces, like genfull does.
+Result parse_all(std::vector<CGDFile::container_type::iterator> const& files, std::vector<std::string> const& contents)
+{
+  Result result;
+  result.bytes = 0;
+  result.lines = 0;
+  struct timeval start;
+  gettimeofday(&start, NULL);
+  CGDRecord record;
+  std::string buffer;
+  for (size_t index = 0; index < files.size(); ++index)
+  {
+    std::string const& filename(files[index]->long_name());
+    char const* const begin = contents[index].data();
+    char const* const end = begin + contents[index].size();
+    int line_nr = 0;
+    for (char const* line = begin; line < end;)
+    {
+      char const* eol = static_cast<char const*>(memchr(line, '\n', end - line));
+      if (!eol)
+	eol = end;
+      record.parse_raw(line, eol - line, filename, ++line_nr);
+      record.resolve_functions(*files[index], buffer);
+      line = eol + 1;
+    }
+    result.lines += line_nr;
+    result.bytes += end - begin;
+  }
+  struct timeval stop;
+  gettimeofday(&stop, NULL);
+  result.seconds = (stop.tv_sec - start.tv_sec) + (stop.tv_usec - start.tv_usec) * 1e-6;
+  return result;
+}
+
+// Print the fastest of 'repeat' runs of parse_all with every tokenizer that the CPU supports.
+void benchmark_tokenizers(int repeat)
+{
+  std::vector<CGDFile::container_type::iterator> files;
+  std::vector<std::string> contents;
+  for (CGDFile::container_type::iterator iter = CGDFile::container.begin(); iter != CGDFile::container.end(); ++iter)
+  {
+    if (iter->in_corpus() || cgd_format(iter->long_name().c_str()) != cgd_format_text)
+      continue;
+    MappedFile input(iter->long_name());
+    files.push_back(iter);
+    contents.push_back(std::string(input.begin(), input.end()));
+  }
+  CGDRecord::tokenizer_type const default_tokenizer = CGDRecord::tokenizer();
+  CGDRecord::tokenizer_type const tokenizers[] = { CGDRecord::tokenizer_scalar, CGDRecord::tokenizer_sse2, CGDRecord::tokenizer_avx2 };
+  std::cout << "Tokenizer Files     Records   MB      Seconds  MB/s      Records/s\n";
+  std::cout << std::fixed;
+  for (size_t t = 0; t < sizeof(tokenizers) / sizeof(CGDRecord::tokenizer_type); ++t)
+  {
+    if (!CGDRecord::set_tokenizer(tokenizers[t]))
+      continue;
+    Result best = Result();
+    for (int run = 0; run < repeat; ++run)
+    {
+      Result result = parse_all(files, contents);
+      if (run == 0 || result.seconds < best.seconds)
+	best = result;
+    }
+    std::cout << std::left << std::setw(10) << CGDRecord::tokenizer_name(tokenizers[t]) << std::setw(10) << files.size() <<
+	std::setw(10) << best.lines << std::setprecision(1) << std::setw(8) << best.bytes / 1048576.0 <<
+	std::setprecision(4) << std::setw(9) << best.seconds << std::setprecision(1) << std::setw(10);
+    if (best.seconds > 0)
+      std::cout << best.bytes / 1048576.0 / best.seconds << best.lines / best.seconds;
+    else
+      std::cout << "-" << "-";
+    std::cout << std::endl;
+  }
+  CGDRecord::set_tokenizer(default_tokenizer);
+}
+
+} // namespace
+
+int main(int argc, char* const argv[])
+{
+  Debug(debug::init());
+
+  // Make a copy of this.
+  std::string program_name(argv[0]);
+
+  // Parse command line arguments.
+  bool print_usage = false;
+  bool tokenizers = false;
+  int repeat = 3;
+  int jobs = 1;
+  int exit_code = exit_code_success;
+  std::string builddir = ".";
+  std::vector<std::string> cmdline_subdirs;
+
+  while (1)
+  {
+    int option_index = 0;
+    static struct option long_options[] = {
+      { "builddir", 1, 0, 'b' },
+      { "subdir", 1, 0, 's' },
+      { "repeat", 1, 0, 'r' },
+      { "jobs", 1, 0, 'j' },
+      { "tokenizer", 0, 0, 't' },
+      { "help", 0, 0, 'h' },
+      { 0, 0, 0, 0 }
+    };
+
+    int c = getopt_long(argc, argv, "b:hj:r:s:t", long_options, &option_index);
+    if (c == -1)
+      break;
+
+    switch (c)
+    {
+      case 'b':
+        builddir = optarg;
+	break;
+      case 's':
+        cmdline_subdirs.push_back(std::string(optarg));
+	break;
+      case 'r':
+        repeat = atoi(optarg);
+	if (repeat < 1)
+	{
+	  std::cerr << program_name << ": --repeat \"" << optarg << "\": must be at least 1." << std::endl;
+	  exit_code = error_unknown_option;
+	}
+	break;
+      case 'j':
+        jobs = atoi(optarg);
+	if (jobs < 1)
+	{
+	  std::cerr << program_name << ": --jobs \"" << optarg << "\": the number of jobs must be at least 1." << std::endl;
+	  exit_code = error_unknown_option;
+	}
+	break;
+      case 't':
+        tokenizers = true;
+	break;
+      case 'h':
+        print_usage = true;
+        break;
+      case '?':
+        print_usage = true;
+	exit_code = error_unknown_option;
+        break;
+      default:
+        std::cerr << "?? getopt returned character code " << c << " ??\n";
+    }
+  }
+
+  if (print_usage)
+  {
+    std::ostream* out = (exit_code == 0) ? &std::cout : &std::cerr;
+    *out << "Usage: " << program_name << " [options]" << std::endl;
+    *out << "Options:\n";
+    *out << "\t--help, -h\t\t\tPrint this help and exit successfully.\n";
+    *out << "\t--builddir, -b <builddir>\tThe build directory [default: current directory].\n";
+    *out << "\t--subdir, -s <subdir>\t\tSubdirectories to scan.\n";
+    *out << "\t--repeat, -r <n>\t\tNumber of runs per measurement; the fastest is reported [default: 3].\n";
+    *out << "\t--jobs, -j <n>\t\t\tNumber of threads used to find the input files [default: 1].\n";
+    *out << "\t--tokenizer, -t\t\t\tBenchmark the record tokenizers instead of the input backends.\n";
+    *out << "\nReads all \".cgd\" files with every input backend of genfull (--io),\n";
+    *out << "both with a cold page cache (the files are evicted with POSIX_FADV_DONTNEED\n";
+    *out << "before every run) and with a warm page cache.\n";
+    *out << "With --tokenizer, parses all records of the \".cgd\" files in memory with every\n";
+    *out << "tokenizer that the CPU supports, including the rewriting of anonymous namespaces." << std::endl;
+  }
+
+  if (print_usage || exit_code != 0)
+    return exit_code;
+
+  try
+  {
+    initialize_subdirs(builddir, cmdline_subdirs);
+    CGDSample all;
+    initialize_cgd_files(jobs, all);
+
+    if (tokenizers)
+      benchmark_tokenizers(repeat);
+    else
+      benchmark_backends(repeat);
+  }
+  catch (std::runtime_error const& error)
+  {
+    Debug(edragon::caught(error));
+    std::cerr << program_name << ": " << error.what() << std::endl;
+    exit_code = error_runtime_exception;
+  }
+  catch (no_cgd_files const& error)
+  {
+    Debug(edragon::caught(error));
+    std::cerr << program_name << ": No \".cgd\" input files found." << std::endl;
+    exit_code = error_no_input;
+  }
+
+  // Flush all remaining debug output.
+  Dout(dc::always|noprefix_cf|nonewline_cf|flush_cf, "");
+  return exit_code;
+}
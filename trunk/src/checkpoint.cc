@@ -0,0 +1,321 @@
+// cppgraph -- C++ call graph analyzer
+//
+//! @file checkpoint.cc
+//! @brief This file contains the implementation of the checkpoint functions.
+//
+// Copyright (C) 2006, by Timmy <timmy1992@gmail.com>
+//
+// This file may be distributed under the terms of the Q Public License
+// version 1.0 as appearing in the file LICENSE.QPL included in the
+// packaging of this file.
+
+#include "sys.h"
+#include <cerrno>
+#include <cstring>
+#include <cstdio>
+#include <fstream>
+#include <vector>
+#include <algorithm>
+#include <boost/archive/binary_oarchive.hpp>
+#include <boost/archive/binary_iarchive.hpp>
+#include <boost/archive/archive_exception.hpp>
+#include <boost/serialization/string.hpp>
+#include "checkpoint.h"
+#include "CGDFile.h"
+#include "FileName.h"
+#include "Location.h"
+#include "Class.h"
+#include "Function.h"
+#include "Edge.h"
+#include "exceptions.h"
+#include "debug.h"
+
+// A checkpoint is the line "#cgdcheckpoint <version>", followed by a binary boost archive
+// that contains, in this order:
+//
+//   the phase, the options and sample.found;
+//   the input files: long name, corpus and index in the corpus;
+// after checkpoint_ingestion:
+//   the file names: long name;
+//   the source file of every input file: the index of its file name, or -1;
+//   the locations: the index of the file name and the line number;
+//   (after checkpoint_classes) the classes and namespaces: base name and is_class;
+//   the functions: name, index of the declaration file, index of the input file
+//     that contains the definition or -1 and (after checkpoint_classes) the index of the class;
+//   the edges: the index of the caller and of the callee, the number of call sites
+//     and for each call site the index of the file name and the line number.
+//
+// The declarations of the functions are not stored, they are parsed again when needed.
+//
+// The indices are serialization indices, see ElementBase. Since all elements are
+// added again in the order of their containers, restoring a checkpoint results in
+// the same containers as the ones that were saved.
+
+namespace {
+
+char const* const header = "#cgdcheckpoint 4";
+int const none = -1;
+
+} // namespace
+
+char const* checkpoint_phase_name(checkpoint_phase phase)
+{
+  switch (phase)
+  {
+    case checkpoint_none:
+      return "none";
+    case checkpoint_scan:
+      return "scan";
+    case checkpoint_ingestion:
+      return "ingestion";
+    case checkpoint_classes:
+      return "classes";
+  }
+  return "unknown";
+}
+
+void save_checkpoint(std::string const& filename, checkpoint_phase phase, std::string const& options,
+    CGDSample const& sample)
+{
+  // Write to a temporary file first, so that a crash never leaves a partial checkpoint behind.
+  std::string tmpname(filename + ".tmp");
+  std::ofstream out(tmpname.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+  if (out)
+  {
+    // Boost doesn't check its own header very well, so we add one that can be checked.
+    out << header << '\n';
+    boost::archive::binary_oarchive ar(out);
+    int const phase_number = phase;
+    size_t const found = sample.found;
+    ar << phase_number << options << found;
+
+    CGDFile::initialize_serialization_index();
+    size_t count = CGDFile::container.size();
+    ar << count;
+    for (CGDFile::container_type::iterator iter = CGDFile::container.begin(); iter != CGDFile::container.end(); ++iter)
+    {
+      size_t const corpus_index = iter->corpus_index();
+      ar << iter->long_name() << iter->corpus() << corpus_index;
+    }
+
+    if (phase >= checkpoint_ingestion)
+    {
+      FileName::initialize_serialization_index();
+      count = FileName::container.size();
+      ar << count;
+      for (FileName::container_type::iterator iter = FileName::container.begin(); iter != FileName::container.end(); ++iter)
+	ar << iter->long_name();
+      for (CGDFile::container_type::iterator iter = CGDFile::container.begin(); iter != CGDFile::container.end(); ++iter)
+      {
+	int const source_file = iter->has_source_file() ? iter->source_file().get_serialization_index() : none;
+	ar << source_file;
+      }
+      count = Location::container.size();
+      ar << count;
+      for (Location::container_type::iterator iter = Location::container.begin(); iter != Location::container.end(); ++iter)
+      {
+	int const file = iter->get_file().get_serialization_index();
+	int const line_nr = iter->line_nr();
+	ar << file << line_nr;
+      }
+      if (phase >= checkpoint_classes)
+      {
+	Class::initialize_serialization_index();
+	count = Class::container.size();
+	ar << count;
+	for (Class::container_type::iterator iter = Class::container.begin(); iter != Class::container.end(); ++iter)
+	{
+	  bool const is_class = iter->is_class();
+	  ar << iter->base_name() << is_class;
+	}
+      }
+      Function::initialize_serialization_index();
+      count = Function::container.size();
+      ar << count;
+      for (Functions::iterator iter = Function::container.begin(); iter != Function::container.end(); ++iter)
+      {
+	int const file = iter->get_file().get_serialization_index();
+	int const cgd_file = iter->has_definition() ? iter->cgd_file()->get_serialization_index() : none;
+	ar << iter->name() << file << cgd_file;
+	if (phase >= checkpoint_classes)
+	{
+	  int const class_index = iter->get_class().get_serialization_index();
+	  ar << class_index;
+	}
+      }
+      count = Edge::container.size();
+      ar << count;
+      for (Edges::iterator iter = Edge::container.begin(); iter != Edge::container.end(); ++iter)
+      {
+	int const caller = iter->get_caller().get_serialization_index();
+	int const callee = iter->get_callee().get_serialization_index();
+	count = iter->call_sites().size();
+	ar << caller << callee << count;
+	for (Location::container_type::const_iterator call_site = iter->call_sites().begin(); call_site != iter->call_sites().end(); ++call_site)
+	{
+	  int const file = call_site->get_file().get_serialization_index();
+	  int const line_nr = call_site->line_nr();
+	  ar << file << line_nr;
+	}
+      }
+    }
+  }
+  out.close();
+  if (!out)
+  {
+    int saved_errno = errno;
+    std::remove(tmpname.c_str());
+    THROW_EXCEPTION(std::runtime_error(tmpname + ": " + strerror(saved_errno)),
+	"save_checkpoint(\"" << filename << "\"): writing failed");
+  }
+  if (std::rename(tmpname.c_str(), filename.c_str()) == -1)
+  {
+    int saved_errno = errno;
+    std::remove(tmpname.c_str());
+    THROW_EXCEPTION(std::runtime_error("rename: " + filename + ": " + strerror(saved_errno)),
+	"save_checkpoint(\"" << filename << "\"): rename failed");
+  }
+  Dout(dc::notice, "Wrote checkpoint \"" << filename << "\" after phase " << checkpoint_phase_name(phase) << '.');
+}
+
+checkpoint_phase restore_checkpoint(std::string const& filename, std::string const& options,
+    CGDSample& sample)
+{
+  std::ifstream in(filename.c_str(), std::ios::in | std::ios::binary);
+  if (!in)
+    THROW_EXCEPTION(std::runtime_error(filename + ": " + strerror(errno)),
+	"restore_checkpoint(\"" << filename << "\"): open failed");
+  std::string line;
+  std::getline(in, line);
+  if (line != header)
+    THROW_EXCEPTION(std::runtime_error(filename + ": not a checkpoint of this version of genfull"),
+	"restore_checkpoint(\"" << filename << "\"): header \"" << line << '"');
+  checkpoint_phase phase;
+  try
+  {
+    boost::archive::binary_iarchive ar(in);
+    int phase_number;
+    std::string file_options;
+    size_t found;
+    ar >> phase_number >> file_options >> found;
+    if (file_options != options)
+      THROW_EXCEPTION(std::runtime_error(filename + ": the checkpoint was made with different input options"),
+	  "restore_checkpoint(\"" << filename << "\"): options differ");
+    phase = static_cast<checkpoint_phase>(phase_number);
+    sample.found = found;
+
+    size_t count;
+    ar >> count;
+    std::vector<CGDFile::container_type::iterator> cgd_files(count);
+    for (size_t index = 0; index < count; ++index)
+    {
+      std::string long_name;
+      std::string corpus;
+      size_t corpus_index;
+      ar >> long_name >> corpus >> corpus_index;
+      cgd_files[index] = add_cgd_file(long_name);
+      if (!corpus.empty())
+	cgd_files[index]->set_corpus(corpus, corpus_index);
+    }
+    CGDFile::generate_short_names();
+
+    if (phase >= checkpoint_ingestion)
+    {
+      ar >> count;
+      std::vector<FileName::container_type::iterator> file_names(count);
+      for (size_t index = 0; index < count; ++index)
+      {
+	std::string long_name;
+	ar >> long_name;
+	FileName const file_name(long_name);
+	file_names[index] = file_name.get_iter();
+      }
+      for (size_t index = 0; index < cgd_files.size(); ++index)
+      {
+	int source_file;
+	ar >> source_file;
+	if (source_file != none)
+	  cgd_files[index]->set_source_file(*file_names[source_file]);
+      }
+      ar >> count;
+      Location::container_type locations;
+      locations.reserve(count);
+      for (size_t index = 0; index < count; ++index)
+      {
+	int file;
+	int line_nr;
+	ar >> file >> line_nr;
+	locations.push_back(Location(*file_names[file], line_nr));
+      }
+      Location::add(locations);
+      std::vector<Class::container_type::iterator> classes;
+      if (phase >= checkpoint_classes)
+      {
+	ar >> count;
+	classes.resize(count);
+	for (size_t index = 0; index < count; ++index)
+	{
+	  std::string base_name;
+	  bool is_class;
+	  ar >> base_name >> is_class;
+	  Class const a_class(base_name);
+	  if (is_class)
+	    const_cast<Class&>(*a_class.get_iter()).set_class();
+	  classes[index] = a_class.get_iter();
+	}
+      }
+      ar >> count;
+      std::vector<Functions::iterator> functions(count);
+      for (size_t index = 0; index < count; ++index)
+      {
+	std::string name;
+	int file;
+	int cgd_file;
+	ar >> name >> file >> cgd_file;
+	if (cgd_file != none)
+	{
+	  Function const function(name, *file_names[file], cgd_files[cgd_file]);
+	  functions[index] = function.get_iter();
+	}
+	else
+	{
+	  Function const function(name, *file_names[file]);
+	  functions[index] = function.get_iter();
+	}
+	if (phase >= checkpoint_classes)
+	{
+	  int class_index;
+	  ar >> class_index;
+	  const_cast<Function&>(*functions[index]).set_class(classes[class_index]);
+	}
+      }
+      ar >> count;
+      for (size_t index = 0; index < count; ++index)
+      {
+	int caller;
+	int callee;
+	size_t call_sites_count;
+	ar >> caller >> callee >> call_sites_count;
+	Edges::iterator edge = const_cast<Function&>(*functions[caller]).add_callee(*functions[callee], Edge::container.end());
+	Location::container_type& call_sites(const_cast<Edge&>(*edge).call_sites());
+	call_sites.reserve(call_sites_count);
+	for (size_t call_site = 0; call_site < call_sites_count; ++call_site)
+	{
+	  int file;
+	  int line_nr;
+	  ar >> file >> line_nr;
+	  call_sites.push_back(Location(*file_names[file], line_nr));
+	}
+	// The file names were numbered in a different order than when the checkpoint was written.
+	std::sort(call_sites.begin(), call_sites.end());
+      }
+    }
+  }
+  catch (boost::archive::archive_exception const& error)
+  {
+    THROW_EXCEPTION(std::runtime_error(filename + ": damaged checkpoint (" + error.what() + ")"),
+	"restore_checkpoint(\"" << filename << "\"): " << error.what());
+  }
+  Dout(dc::notice, "Restored checkpoint \"" << filename << "\" after phase " << checkpoint_phase_name(phase) << '.');
+  return phase;
+}
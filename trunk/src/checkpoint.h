@@ -0,0 +1,43 @@
+// cppgraph -- C++ call graph analyzer
+//
+//! @file checkpoint.h
+//! @brief This file contains the declaration of the checkpoint functions.
+//
+// Copyright (C) 2006, by Timmy <timmy1992@gmail.com>
+//
+// This file may be distributed under the terms of the Q Public License
+// version 1.0 as appearing in the file LICENSE.QPL included in the
+// packaging of this file.
+
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#include <string>
+
+struct CGDSample;
+
+// The phases of genfull after which a checkpoint is written, in the order in which they are run.
+// The directory and project analysis is not among them: it only depends on the file names
+// (and the command line options), and takes no time compared to the phases around it.
+enum checkpoint_phase {
+  checkpoint_none,		// Nothing done yet.
+  checkpoint_scan,		// The input files were found (CGDFile::container).
+  checkpoint_ingestion,		// The input files were read (FileName, Location, Function and Edge).
+  checkpoint_classes		// Every function was assigned to a class or namespace.
+};
+
+// Return a printable name of 'phase'.
+char const* checkpoint_phase_name(checkpoint_phase phase);
+
+// Write the state of genfull after 'phase' to 'filename', replacing it atomically.
+// 'options' are the command line options that determine that state.
+void save_checkpoint(std::string const& filename, checkpoint_phase phase, std::string const& options,
+    CGDSample const& sample);
+
+// Restore the state of genfull from the checkpoint 'filename', that must have been
+// written with the same 'options'. All containers must still be empty.
+// Returns the phase after which the checkpoint was written.
+checkpoint_phase restore_checkpoint(std::string const& filename, std::string const& options,
+    CGDSample& sample);
+
+#endif // CHECKPOINT_H
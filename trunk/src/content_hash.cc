@@ -0,0 +1,52 @@
+// cppgraph -- C++ call graph analyzer
+//
+//! @file content_hash.cc
+//! @brief This file contains the implementation of function content_hash.
+//
+// Copyright (C) 2006, by Timmy <timmy1992@gmail.com>
+//
+// This file may be distributed under the terms of the Q Public License
+// version 1.0 as appearing in the file LICENSE.QPL included in the
+// packaging of this file.
+
+#include <cstring>
+#include "content_hash.h"
+
+uint64_t content_hash(char const* data, size_t size, uint64_t seed)
+{
+  uint64_t const m = 0xc6a4a7935bd1e995ULL;
+  int const r = 47;
+  uint64_t h = seed ^ (size * m);
+  char const* const end = data + (size & ~static_cast<size_t>(7));
+  for (; data != end; data += 8)
+  {
+    uint64_t k;
+    memcpy(&k, data, 8);
+    k *= m;
+    k ^= k >> r;
+    k *= m;
+    h ^= k;
+    h *= m;
+  }
+  switch (size & 7)
+  {
+    case 7: h ^= static_cast<uint64_t>(static_cast<unsigned char>(data[6])) << 48;
+      // fall through
+    case 6: h ^= static_cast<uint64_t>(static_cast<unsigned char>(data[5])) << 40;
+      // fall through
+    case 5: h ^= static_cast<uint64_t>(static_cast<unsigned char>(data[4])) << 32;
+      // fall through
+    case 4: h ^= static_cast<uint64_t>(static_cast<unsigned char>(data[3])) << 24;
+      // fall through
+    case 3: h ^= static_cast<uint64_t>(static_cast<unsigned char>(data[2])) << 16;
+      // fall through
+    case 2: h ^= static_cast<uint64_t>(static_cast<unsigned char>(data[1])) << 8;
+      // fall through
+    case 1: h ^= static_cast<uint64_t>(static_cast<unsigned char>(data[0]));
+      h *= m;
+  }
+  h ^= h >> r;
+  h *= m;
+  h ^= h >> r;
+  return h;
+}
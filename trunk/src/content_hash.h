@@ -0,0 +1,23 @@
+// cppgraph -- C++ call graph analyzer
+//
+//! @file content_hash.h
+//! @brief This file contains the declaration of function content_hash.
+//
+// Copyright (C) 2006, by Timmy <timmy1992@gmail.com>
+//
+// This file may be distributed under the terms of the Q Public License
+// version 1.0 as appearing in the file LICENSE.QPL included in the
+// packaging of this file.
+
+#ifndef CONTENT_HASH_H
+#define CONTENT_HASH_H
+
+#include <cstddef>
+#include <stdint.h>
+
+// A cheap 64 bit hash of [data, data + size) (MurmurHash64A). Used to recognize
+// byte-identical input files, and by the symbol table. A different seed gives
+// an unrelated hash function.
+uint64_t content_hash(char const* data, size_t size, uint64_t seed = 0x8445d61a4e774912ULL);
+
+#endif // CONTENT_HASH_H
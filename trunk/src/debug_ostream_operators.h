@@ -16,10 +16,8 @@
 class Function;
 class FunctionDecl;
 class Project;
-class ClassDecl;
 
 std::ostream& operator<<(std::ostream& os, FunctionDecl const& decl);
 std::ostream& operator<<(std::ostream& os, Project const& project);
-std::ostream& operator<<(std::ostream& os, ClassDecl const& class_decl);
 
 #endif // DEBUG_OSTREAM_OPERATORS_H
@@ -21,23 +21,23 @@ struct ClassCallerFilter {
   {
     Dout(dc::notice, "CALLER: " << caller);
     return caller.get_project().short_name() != "src" ||
-           !(caller.decl().function_name == "init_dir_inode_to_block_cache" ||
-             caller.decl().function_name == "init_directories" ||
-             caller.decl().function_name == "init_files" ||
-             caller.decl().function_name == "dir_inode_to_block" ||
-             caller.decl().function_name == "print_directory_inode" ||
-             caller.decl().function_name == "dump_names" ||
-             caller.decl().function_name == "show_hardlinks" ||
-             caller.decl().function_name == "restore_file" ||
-             caller.decl().function_name == "filter_dir_entry" ||
-             caller.decl().function_name == "init_directories_action" ||
-             caller.decl().function_name == "extended_directory_action" ||
-             caller.decl().function_name == "init_directories" ||
-             caller.decl().function_name == "filter_dir_entry" ||
-             caller.decl().function_name == "iterate_over_directory" ||
-             caller.decl().function_name == "init_directories_action" ||
-             caller.decl().function_name == "link_extended_directory_block_to_inode" ||
-             caller.decl().function_name == "extended_directory_action");
+           !(caller.decl().equals(caller.decl().function_name, "init_dir_inode_to_block_cache") ||
+             caller.decl().equals(caller.decl().function_name, "init_directories") ||
+             caller.decl().equals(caller.decl().function_name, "init_files") ||
+             caller.decl().equals(caller.decl().function_name, "dir_inode_to_block") ||
+             caller.decl().equals(caller.decl().function_name, "print_directory_inode") ||
+             caller.decl().equals(caller.decl().function_name, "dump_names") ||
+             caller.decl().equals(caller.decl().function_name, "show_hardlinks") ||
+             caller.decl().equals(caller.decl().function_name, "restore_file") ||
+             caller.decl().equals(caller.decl().function_name, "filter_dir_entry") ||
+             caller.decl().equals(caller.decl().function_name, "init_directories_action") ||
+             caller.decl().equals(caller.decl().function_name, "extended_directory_action") ||
+             caller.decl().equals(caller.decl().function_name, "init_directories") ||
+             caller.decl().equals(caller.decl().function_name, "filter_dir_entry") ||
+             caller.decl().equals(caller.decl().function_name, "iterate_over_directory") ||
+             caller.decl().equals(caller.decl().function_name, "init_directories_action") ||
+             caller.decl().equals(caller.decl().function_name, "link_extended_directory_block_to_inode") ||
+             caller.decl().equals(caller.decl().function_name, "extended_directory_action"));
   }
 };
 
@@ -47,23 +47,23 @@ struct ClassCalleeFilter {
   {
     Dout(dc::notice, "CALLEE: " << callee << "(class base_name \"" << callee.get_class().base_name() << ")");
     return callee.get_project().short_name() != "src" ||
-           !(callee.decl().function_name == "init_dir_inode_to_block_cache" ||
-             callee.decl().function_name == "init_directories" ||
-             callee.decl().function_name == "init_files" ||
-             callee.decl().function_name == "dir_inode_to_block" ||
-             callee.decl().function_name == "print_directory_inode" ||
-             callee.decl().function_name == "dump_names" ||
-             callee.decl().function_name == "show_hardlinks" ||
-             callee.decl().function_name == "restore_file" ||
-             callee.decl().function_name == "filter_dir_entry" ||
-             callee.decl().function_name == "init_directories_action" ||
-             callee.decl().function_name == "extended_directory_action" ||
-             callee.decl().function_name == "init_directories" ||
-             callee.decl().function_name == "filter_dir_entry" ||
-             callee.decl().function_name == "iterate_over_directory" ||
-             callee.decl().function_name == "init_directories_action" ||
-             callee.decl().function_name == "link_extended_directory_block_to_inode" ||
-             callee.decl().function_name == "extended_directory_action");
+           !(callee.decl().equals(callee.decl().function_name, "init_dir_inode_to_block_cache") ||
+             callee.decl().equals(callee.decl().function_name, "init_directories") ||
+             callee.decl().equals(callee.decl().function_name, "init_files") ||
+             callee.decl().equals(callee.decl().function_name, "dir_inode_to_block") ||
+             callee.decl().equals(callee.decl().function_name, "print_directory_inode") ||
+             callee.decl().equals(callee.decl().function_name, "dump_names") ||
+             callee.decl().equals(callee.decl().function_name, "show_hardlinks") ||
+             callee.decl().equals(callee.decl().function_name, "restore_file") ||
+             callee.decl().equals(callee.decl().function_name, "filter_dir_entry") ||
+             callee.decl().equals(callee.decl().function_name, "init_directories_action") ||
+             callee.decl().equals(callee.decl().function_name, "extended_directory_action") ||
+             callee.decl().equals(callee.decl().function_name, "init_directories") ||
+             callee.decl().equals(callee.decl().function_name, "filter_dir_entry") ||
+             callee.decl().equals(callee.decl().function_name, "iterate_over_directory") ||
+             callee.decl().equals(callee.decl().function_name, "init_directories_action") ||
+             callee.decl().equals(callee.decl().function_name, "link_extended_directory_block_to_inode") ||
+             callee.decl().equals(callee.decl().function_name, "extended_directory_action"));
   }
 };
 
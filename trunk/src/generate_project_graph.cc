@@ -20,8 +20,8 @@ struct ProjectCallerFilter {
   bool operator()(Function const& caller)
   {
     return
-        caller.decl().is_template() ||
-        caller.decl().function_name.substr(0, 6) == "__tcf_";
+        caller.is_template() ||
+        caller.function_name_starts_with("__tcf_");
   }
 };
 
@@ -29,7 +29,7 @@ struct ProjectCalleeFilter {
   static NodeType const type = project_node;
   bool operator()(Function const& callee)
   {
-    return callee.decl().function_name.substr(0, 6) == "__cxa_";
+    return callee.function_name_starts_with("__cxa_");
   }
 };
 
@@ -16,11 +16,13 @@
 #include <set>
 #include <sys/types.h>
 #include <getopt.h>
-#include <fstream>
 #include <cstdlib>
 #include <algorithm>
 #include <map>
 #include <iomanip>
+#include <cmath>
+#include <sys/time.h>
+#include <sstream>
 #include "realpath.h"
 #include "exceptions.h"
 #include "Subdir.h"
@@ -31,16 +33,20 @@
 #include "Directory.h"
 #include "DirTree.h"
 #include "Project.h"
-#include "parser.h"
 #include "Class.h"
 #include "CGDFile.h"
 #include "debug.h"
 #include "generate_project_graph.h"
 #include "generate_class_graph.h"
 #include "Graph.h"
+#include "CallGraph.h"
+#include "Arena.h"
 #include "serialization.h"
-
-void process_input_line(char const* line, CGDFile::container_type::iterator cgd_file, int line_nr, std::string const& curdir);
+#include "read_cgd_files.h"
+#include "RecordFilter.h"
+#include "Symbol.h"
+#include "CGDRecord.h"
+#include "checkpoint.h"
 
 int const exit_code_success = 0;
 int const error_parent_dir = 1;		// --subdir contains ".."
@@ -83,6 +89,14 @@ int main(int argc, char* const argv[])
   bool print_usage = false;
   bool print_version = false;
   int verbose = 0;
+  int jobs = 1;
+  io_backend_type io_backend = io_backend_mmap;
+  std::string stream;
+  RecordFilter filter;
+  CGDSample sample;
+  std::string checkpoint;
+  std::string resume;
+  std::string input_options;		// The options that determine what is read, see --resume.
   int exit_code = exit_code_success;
   std::string builddir = ".";
   std::vector<std::string> cmdline_subdirs;
@@ -106,16 +120,32 @@ int main(int argc, char* const argv[])
       { "projectdir", 1, 0, 'p' },
       { "prefix", 1, 0, 'g' },
       { "system", 1, 0, 'y' },
+      { "jobs", 1, 0, 'j' },
+      { "io", 1, 0, 'i' },
+      { "stream", 1, 0, 'S' },
+      { "exclude-function", 1, 0, 'x' },
+      { "exclude-file", 1, 0, 'X' },
+      { "sample", 1, 0, 'n' },
+      { "sample-seed", 1, 0, 'N' },
+      { "checkpoint", 1, 0, 'c' },
+      { "resume", 1, 0, 'r' },
       { "verbose", 0, 0, 'v' },
       { "help", 0, 0, 'h' },
       { "version", 0, 0, 'V' },
       { 0, 0, 0, 0 }
     };
 
-    int c = getopt_long(argc, argv, "b:hs:p:g:y:vV", long_options, &option_index);
+    int c = getopt_long(argc, argv, "b:c:hi:j:n:N:r:s:S:p:g:y:x:X:vV", long_options, &option_index);
     if (c == -1)
       break;
 
+    if (std::string("bsSxXnN").find(static_cast<char>(c)) != std::string::npos)
+    {
+      input_options += static_cast<char>(c);
+      input_options += optarg;
+      input_options += '\n';
+    }
+
     switch (c)
     {
       case 'b':
@@ -132,6 +162,51 @@ int main(int argc, char* const argv[])
 	}
         cmdline_subdirs.push_back(std::string(optarg));
 	break;
+      case 'S':
+        stream = optarg;
+	break;
+      case 'x':
+        filter.exclude_function(optarg);
+	break;
+      case 'X':
+        if (*optarg != '/')
+	{
+	  std::cerr << program_name << ": --exclude-file \"" << optarg << "\": must be an absolute path." << std::endl;
+	  exit_code = error_unknown_option;
+	  break;
+	}
+        filter.exclude_file(optarg);
+	break;
+      case 'n':
+      {
+        char* end;
+	sample.size = strtod(optarg, &end);
+	if (end == optarg || *end || !(sample.size > 0) || (sample.size > 1 && sample.size != std::floor(sample.size)))
+	{
+	  std::cerr << program_name << ": --sample \"" << optarg << "\": must be a fraction (0 < fraction < 1) or a number of input files." << std::endl;
+	  exit_code = error_unknown_option;
+	}
+	break;
+      }
+      case 'N':
+      {
+        char* end;
+	errno = 0;
+	unsigned long seed = strtoul(optarg, &end, 10);
+	if (*optarg < '0' || *optarg > '9' || *end || errno == ERANGE || seed > 0xffffffffUL)
+	{
+	  std::cerr << program_name << ": --sample-seed \"" << optarg << "\": must be a number from 0 to 4294967295." << std::endl;
+	  exit_code = error_unknown_option;
+	}
+	sample.seed = seed;
+	break;
+      }
+      case 'c':
+        checkpoint = optarg;
+	break;
+      case 'r':
+        resume = optarg;
+	break;
       case 'p':
         cmdline_projectdirs.push_back(collapsedpath(std::string(optarg)));
         break;
@@ -141,6 +216,27 @@ int main(int argc, char* const argv[])
       case 'y':
         cmdline_systemdirs.push_back(collapsedpath(std::string(optarg)));
         break;
+      case 'j':
+        jobs = atoi(optarg);
+	if (jobs < 1)
+	{
+	  std::cerr << program_name << ": --jobs \"" << optarg << "\": the number of jobs must be at least 1." << std::endl;
+	  exit_code = error_unknown_option;
+	}
+	break;
+      case 'i':
+        if (!strcmp(optarg, "mmap"))
+	  io_backend = io_backend_mmap;
+	else if (!strcmp(optarg, "pread"))
+	  io_backend = io_backend_pread;
+	else if (!strcmp(optarg, "uring"))
+	  io_backend = io_backend_uring;
+	else
+	{
+	  std::cerr << program_name << ": --io \"" << optarg << "\": must be one of mmap, pread or uring." << std::endl;
+	  exit_code = error_unknown_option;
+	}
+	break;
       case 'v':
         ++verbose;
 	break;
@@ -159,6 +255,16 @@ int main(int argc, char* const argv[])
     }
   }
 
+  if (sample.enabled() && !stream.empty() && exit_code == 0)
+  {
+    std::cerr << program_name << ": --sample can not be used together with --stream." << std::endl;
+    exit_code = error_unknown_option;
+  }
+
+  // Keep the checkpoint that we resume from up to date.
+  if (checkpoint.empty())
+    checkpoint = resume;
+
   // Print version info if requested.
   if (print_version)
     std::cout << "cppgraph v1.0." << std::endl;
@@ -176,11 +282,41 @@ int main(int argc, char* const argv[])
     *out << "\t--projectdir, -p <dir>\t\tDirectories that contains files of a single project [default: auto].\n";
     *out << "\t--prefix, -g <dir>\t\tGeneral install prefix used for MORE than one project.\n";
     *out << "\t--system, -y <dir>\t\tSystem directories [default: /usr/include/{sys|asm|bits}].\n";
+    *out << "\t--jobs, -j <n>\t\t\tNumber of threads used to find and read the input files [default: 1].\n";
+    *out << "\t--io, -i <mmap|pread|uring>\tHow to read the input files [default: mmap];\n";
+    *out << "\t\t\t\t\turing falls back to pread when io_uring is not available.\n";
+    *out << "\t--stream, -S <file|->\t\tRead framed \".cgd\" records from a file, FIFO or stdin (-)\n";
+    *out << "\t\t\t\t\tinstead of searching the subdirectories.\n";
+    *out << "\t--exclude-function, -x <pattern>\tIgnore calls to and from, and definitions of, matching functions.\n";
+    *out << "\t--exclude-file, -X <prefix>\tIgnore definitions and calls in, and calls to functions declared in,\n";
+    *out << "\t\t\t\t\tfiles whose absolute path starts with <prefix>.\n";
+    *out << "\t--sample, -n <fraction|count>\tOnly read a fraction, or a number, of the input files (a preview).\n";
+    *out << "\t--sample-seed, -N <n>\t\tSelect a different sample [default: 0].\n";
+    *out << "\t--checkpoint, -c <file>\t\tWrite a checkpoint to <file> after each phase.\n";
+    *out << "\t--resume, -r <file>\t\tContinue after the last phase in the checkpoint <file>.\n";
     *out << "\t--verbose, -v\t\t\tIncrease verbosity.\n";
     *out << "\nEach directory is scanned recursively unless a subdirectory\n";
     *out << "of that (sub)directory is specified with --subdir (-s).\n";
     *out << "By default, /usr and /usr/local are considered to be general install prefixes;\n";
-    *out << "additional ones can be specified with the --prefix option." << std::endl;
+    *out << "additional ones can be specified with the --prefix option.\n";
+    *out << "\nThe <pattern> of --exclude-function is matched against the whole function as\n";
+    *out << "it appears in the \".cgd\" files, including its return type and parameters;\n";
+    *out << "'*' matches any string and '?' any character. For example, -x 'std::*' -x '* std::*'\n";
+    *out << "excludes the functions in namespace std (the first for constructors). Excluded\n";
+    *out << "records are dropped while reading the input files.\n";
+    *out << "\nWith --stream, every \".cgd\" file is sent as a line \"#cgd <length> <path>\",\n";
+    *out << "where <path> is the absolute path of the \".cgd\" file, followed by <length> bytes\n";
+    *out << "of records (at most 1 GB). The stream ends at end-of-file, or with a line \"#end\"\n";
+    *out << "(a FIFO is kept open until then). Writers to a shared FIFO must not interleave\n";
+    *out << "their frames.\n";
+    *out << "\nWith --sample, the same seed selects the same input files every time, and a larger\n";
+    *out << "sample contains the files of a smaller one. A corpus (\".cgdm\") is sampled as a\n";
+    *out << "whole. The graphs are labeled as a preview, and -v prints estimates for all files.\n";
+    *out << "\nA checkpoint is written after finding the input files, after reading them and\n";
+    *out << "after assigning the functions to classes. --resume skips those phases that are\n";
+    *out << "in the checkpoint; it must be given the same --builddir, --subdir, --stream,\n";
+    *out << "--exclude-*, --sample and --sample-seed options. Unless --checkpoint is given\n";
+    *out << "too, the checkpoint is updated in place." << std::endl;
   }
 
   // Exit if appropriate.
@@ -193,19 +329,43 @@ int main(int argc, char* const argv[])
     Dout(dc::subdirs, "builddir is \"" << builddir << "\".");
 
     //-----------------------------------------------------------------------------------------------
-    // Get subdirectories to search for .cgd files.
-    initialize_subdirs(builddir, cmdline_subdirs);
-    if (verbose)
+    // Restore the state of an earlier run, and skip the phases that it completed.
+    checkpoint_phase resumed = checkpoint_none;
+    if (!resume.empty())
     {
-      std::cout << "Searching the following subdirectories:" << std::endl;
-      for (SubdirSet::const_iterator iter = subdirs.begin(); iter != subdirs.end(); ++iter)
-        std::cout << iter->realpath() << (iter->is_recursive() ? " (recursive)" : "") << std::endl;
+      resumed = restore_checkpoint(resume, input_options, sample);
+      std::cout << "Resuming from " << resume << ", after the " << checkpoint_phase_name(resumed) << " phase." << std::endl;
     }
 
-    //-----------------------------------------------------------------------------------------------
-    // Determine which files contain the call graph information.
-    initialize_cgd_files();
-    if (verbose)
+    // When reading a stream, the cgd files are added while reading it.
+    if (stream.empty() && resumed < checkpoint_scan)
+    {
+      //---------------------------------------------------------------------------------------------
+      // Get subdirectories to search for .cgd files.
+      initialize_subdirs(builddir, cmdline_subdirs);
+      if (verbose)
+      {
+	std::cout << "Searching the following subdirectories:" << std::endl;
+	for (SubdirSet::const_iterator iter = subdirs.begin(); iter != subdirs.end(); ++iter)
+	  std::cout << iter->realpath() << (iter->is_recursive() ? " (recursive)" : "") << std::endl;
+      }
+
+      //---------------------------------------------------------------------------------------------
+      // Determine which files contain the call graph information.
+      initialize_cgd_files(jobs, sample);
+      if (!checkpoint.empty())
+	save_checkpoint(checkpoint, checkpoint_scan, input_options, sample);
+    }
+    if (sample.enabled())
+    {
+      std::ostringstream label;
+      label << "Preview: " << CGDFile::container.size() << " of " << sample.found << " compilation units (seed " << sample.seed << ")";
+      project_graph.set_label(label.str());
+      class_graph.set_label(label.str());
+      std::cout << "PREVIEW: only reading " << CGDFile::container.size() << " of the " << sample.found <<
+	  " compilation units found (--sample-seed " << sample.seed << ")." << std::endl;
+    }
+    if (stream.empty() && verbose)
     {
       std::cout << "Found " << CGDFile::container.size() << " \".cgd\" input files.\n";
       if (verbose > 1)
@@ -218,44 +378,60 @@ int main(int argc, char* const argv[])
     //---------------------------------------------------------------------------------------------
     // Actually read and process the cgd files.
     // Initialize filenames, functions, locations and edges and assign source files to cgd files.
-    if (verbose)
-    {
-      std::cout << "Scanning \".cgd\" input files" << std::flush;
-      if (verbose > 1)
-	std::cout << '\n';
-    }
-    int const buflen = 4096;
-    char* buf = new char [buflen];
-    AllocTag(buf, "Buffer used for storing input lines while reading .cgd files.");
-    for (CGDFile::container_type::iterator iter = CGDFile::container.begin(); iter != CGDFile::container.end(); ++iter)
+    struct timeval scan_start;
+    gettimeofday(&scan_start, NULL);
+    SkippedDuplicates skipped;
+    double total_bytes = 0;
+    if (resumed < checkpoint_ingestion)
     {
-      if (verbose > 1)
-	std::cout << "  " << iter->long_name() << std::flush;
-      int line_nr = 0;
-      std::string input_file = iter->long_name();
-      std::ifstream input_stream;
-      input_stream.open(input_file.c_str());
-      std::string::size_type pos = input_file.rfind('/');
-      std::string curdir = input_file.substr(0, pos);
-      while (input_stream.getline(buf, buflen))
-	process_input_line(buf, iter, ++line_nr, curdir);
-      input_stream.close();
-      if (verbose == 1)
-	std::cout << '.' << std::flush;
-      else if (verbose > 1)
+      if (verbose)
       {
-        if (iter->has_source_file())
-	  std::cout << " [" << iter->source_file().short_name() << "]\n";
-        else
+	std::cout << "Scanning \".cgd\" input files" << std::flush;
+	if (verbose > 1)
 	  std::cout << '\n';
       }
+      total_bytes = stream.empty() ? read_cgd_files(verbose, jobs, io_backend, filter, skipped) :
+	  read_cgd_stream(verbose, jobs, stream, filter);
     }
-    delete [] buf;
+    struct timeval scan_end;
+    gettimeofday(&scan_end, NULL);
     FileName::generate_short_names();
+    if (!checkpoint.empty() && resumed < checkpoint_ingestion)
+      save_checkpoint(checkpoint, checkpoint_ingestion, input_options, sample);
     if (verbose)
     {
-      if (verbose == 1)
+      if (verbose == 1 && resumed < checkpoint_ingestion)
 	std::cout << " done.\n";
+      if (!stream.empty() && resumed < checkpoint_ingestion)
+	std::cout << "Read " << CGDFile::container.size() << " \".cgd\" files from " << stream << ".\n";
+      double seconds = (scan_end.tv_sec - scan_start.tv_sec) + (scan_end.tv_usec - scan_start.tv_usec) * 1e-6;
+      std::ios::fmtflags flags = std::cout.flags();
+      std::streamsize precision = std::cout.precision();
+      if (resumed < checkpoint_ingestion)
+      {
+	std::cout << "Read " << std::fixed << std::setprecision(1) << total_bytes / 1048576.0 << " MB in " <<
+	    std::setprecision(2) << seconds << " seconds";
+	if (seconds > 0)
+	  std::cout << " (" << std::setprecision(1) << total_bytes / 1048576.0 / seconds << " MB/s)";
+	std::cout << ".\n";
+      }
+      else
+	std::cout << "Restored the input files from the checkpoint.\n";
+      if (skipped.files > 0)
+	std::cout << "Skipped " << skipped.files << " byte-identical copies of other input files (" <<
+	    std::setprecision(1) << skipped.bytes / 1048576.0 << " MB, " << skipped.records << " records).\n";
+      if (!filter.empty() && resumed < checkpoint_ingestion)
+	std::cout << "Excluded " << filter.excluded() << " records with --exclude-function and --exclude-file.\n";
+      std::cout << "Interned " << Symbol::size() << " different names (" <<
+          std::setprecision(1) << Symbol::bytes() / 1048576.0 << " MB).\n";
+      if (CGDRecord::file_lookups() > 0)
+	std::cout << "Found " << CGDRecord::file_lookup_hits() << " of " << CGDRecord::file_lookups() <<
+	    " paths in the file name cache (" << 100.0 * CGDRecord::file_lookup_hits() / CGDRecord::file_lookups() << "% hits).\n";
+      if (CGDRecord::call_lookups() > 0)
+	std::cout << "Found " << CGDRecord::call_lookup_hits() << " of " << CGDRecord::call_lookups() <<
+	    " calls in the call cache (" << 100.0 * CGDRecord::call_lookup_hits() / CGDRecord::call_lookups() << "% hits).\n";
+      std::cout.flags(flags);
+      std::cout.precision(precision);
       std::cout << "Found " << FileName::container.size() << " different source files.\n";
       if (verbose > 2)
       {
@@ -270,6 +446,19 @@ int main(int argc, char* const argv[])
       }
       std::cout << "Found " << Location::container.size() << " different source locations at which functions are defined or called from.\n";
       std::cout << "Found " << Edge::container.size() << " different caller/callee function pairs (edges).\n";
+      size_t call_sites = 0;
+      for (Edges::iterator iter = Edge::container.begin(); iter != Edge::container.end(); ++iter)
+	call_sites += iter->call_sites().size();
+      std::cout << "Found " << call_sites << " different call sites.\n";
+      if (sample.enabled() && !CGDFile::container.empty())
+      {
+	// Linear extrapolation; an upper bound, because functions that are defined or called in more
+	// than one compilation unit (the ones in headers, usually) are only counted once.
+	double scale = static_cast<double>(sample.found) / CGDFile::container.size();
+	std::cout << "Preview: estimated at most " << static_cast<size_t>(Function::container.size() * scale) << " functions, " <<
+	    static_cast<size_t>(Location::container.size() * scale) << " locations and " <<
+	    static_cast<size_t>(Edge::container.size() * scale) << " edges in all " << sample.found << " compilation units.\n";
+      }
     }
 
     //---------------------------------------------------------------------------------------------
@@ -320,6 +509,8 @@ int main(int argc, char* const argv[])
 	  std::cout << '\n';
 	}
       std::cout << "Found " << Project::container.size() << " different project directories.\n";
+      if (sample.enabled())
+	std::cout << "Preview: at least " << Project::container.size() << " project directories in all " << sample.found << " compilation units.\n";
       std::cout << "  Files\tDirectory\n";
       for (Project::container_type::const_iterator iter = Project::container.begin();
           iter != Project::container.end(); ++iter)
@@ -396,52 +587,18 @@ int main(int argc, char* const argv[])
 	std::cout << "g++ resides in project " << gcc_iter->directory() << std::endl;
     }
 
-    //---------------------------------------------------------------------------------------------
-    if (verbose)
-    {
-      std::cout << "Parsing function declarations" << std::flush;
-      if (verbose > 2)
-	std::cout << "..." << std::endl;
-    }
-    int count = 0;			// Number of functions parsed so far.
-    std::set<std::string> types;	// All types, seen so far.
-    for (Functions::iterator next = Function::container.begin(); next != Function::container.end();)
-    {
-      Functions::iterator iter = next++;
-      FunctionDecl& decl(const_cast<Function&>(*iter).decl());
-      if (iter->name()[0] == '(')
-      {
-	if (verbose > 2)
-	  std::cout << "  Special: \'" << iter->name() << "'" << std::endl;
-	// FIXME: add special 'declaration'.
-      }
-      else
-      {
-	if (verbose > 2)
-	  std::cout << "  Parsing: " << iter->name() << std::endl;
-	if (!parse_function_declaration(iter->name(), decl, types))
-	{
-	  if (verbose)
-	    std::cout << "\nWARNING: Parsing failed for '" << iter->name() << "'!" << std::endl;
-	  DoutFatal(dc::fatal, "Parsing failed for '" << iter->name() << "'!");
-	  Function::container.erase(iter);
-	  continue;
-	}
-      }
-      if (verbose && verbose < 3 && ++count % 10 == 0)
-	std::cout << '.' << std::flush;
-    }
-    if (verbose)
-    {
-      if (verbose < 3)
-	std::cout << " done." << std::endl;
-    }
-
     //---------------------------------------------------------------------------------------------
     // Initialize classes.
     if (verbose)
       std::cout << "Analyzing function declarations... " << std::flush;
-    for (Functions::iterator iter = Function::container.begin(); iter != Function::container.end(); ++iter)
+    // After resuming from a checkpoint_classes checkpoint, every function has its class already.
+    // The declarations are parsed here, as they are needed. The types that they contain
+    // are only known after all of them are parsed, see the checks after this loop.
+    std::set<std::string> const& types(Function::types());
+    Functions::iterator const first_unassigned =
+        (resumed < checkpoint_classes) ? Function::container.begin() : Function::container.end();
+    std::vector<Functions::iterator> unparsable;	// Erased after the loop, with their edges.
+    for (Functions::iterator iter = first_unassigned; iter != Function::container.end(); ++iter)
     {
       if (iter->name()[0] == '(')	// Skip 'special' functions, they don't have a declaration.
       {
@@ -450,32 +607,35 @@ int main(int argc, char* const argv[])
 	const_cast<Function&>(*iter).set_class(a_class.get_iter());
         continue;
       }
-      FunctionDecl& decl(const_cast<Function&>(*iter).decl());
+      if (!iter->parse_decl())
+      {
+	if (verbose)
+	  std::cout << "\nWARNING: Parsing failed for '" << iter->name() << "'!" << std::endl;
+	DoutFatal(dc::fatal, "Parsing failed for '" << iter->name() << "'!");
+	unparsable.push_back(iter);
+	continue;
+      }
+      FunctionDecl const& decl(iter->decl());
       Dout(dc::decl, "Analyzing function " << decl);
       Debug(libcw_do.inc_indent(2));
-      // Construct a uniq key for the class of this function, if any.
-      std::string scopename;	// Namespace and class scope thus far.
+      // Find the class of this function, if any, one scope at a time.
+      Classes::iterator scope = Class::container.end();	// Namespace and class scope thus far.
       bool is_class = false;
-      std::vector<ClassDecl>::iterator cd_iter = decl.classes.begin();
-      std::vector<std::string>::iterator cn_iter = decl.class_or_namespaces.begin();
-      bool first = true;
+      std::vector<ClassDecl>::const_iterator cd_iter = decl.classes.begin();
+      std::vector<DeclSlice>::const_iterator cn_iter = decl.class_or_namespaces.begin();
       bool last = (cn_iter == decl.class_or_namespaces.end());
       while (!last)
       {
-	if (!first)
-	  scopename += "::";
-	else
-	  first = false;
-	scopename += *cn_iter;
+	scope = Class::scope(scope, decl.symbol(*cn_iter), false);
+	Class const& a_class(*scope);
 	// Advance iterator.
 	++cn_iter;
         last = cn_iter == decl.class_or_namespaces.end();
 #ifdef CWDEBUG
-	Dout(dc::decl, "scopename set to \"" << scopename << "\" (is_class == " << (is_class ? "true" : "false") << ")");
+	Dout(dc::decl, "scopename set to \"" << a_class.base_name() << "\" (is_class == " << (is_class ? "true" : "false") << ")");
 	if (last)
 	  Dout(dc::decl, "This is the last scopename of decl.class_or_namespaces");
 #endif
-	Class const a_class(scopename);
 	if (!is_class && a_class.is_class())
 	{
 	  is_class = true;
@@ -484,7 +644,7 @@ int main(int argc, char* const argv[])
 	if (is_class && !a_class.is_class())
 	{
 	  Dout(dc::decl, "Calling set_class() for scopename \"" << a_class.base_name() << "\"");
-	  const_cast<Class&>(*a_class.get_iter()).set_class();
+	  const_cast<Class&>(a_class).set_class();
 	}
 	if (!is_class)
 	{
@@ -494,7 +654,7 @@ int main(int argc, char* const argv[])
 		   decl.is_constructor() ||
 		   decl.is_destructor() ||
 		   decl.is_class_operator())) ||
-	      (types.find(scopename) != types.end());
+	      (types.find(a_class.base_name()) != types.end());
 	  if (is_class)
 	  {
 #ifdef CWDEBUG
@@ -526,54 +686,47 @@ int main(int argc, char* const argv[])
 		    break;
 		  }
 		}
-		reason += scopename + " is part of 'types'";
+		reason += a_class.base_name() + " is part of 'types'";
 	      }
 	      while(0);
 	      Dout(dc::decl, reason);
 	    }
 	    Dout(dc::decl, "Calling set_class() for scopename \"" << a_class.base_name() << "\"");
 #endif
-	    const_cast<Class&>(*a_class.get_iter()).set_class();
+	    const_cast<Class&>(a_class).set_class();
 	  }
 	}
 	// Is this the very last?
         if (last && cd_iter == decl.classes.end())
-	  const_cast<Function&>(*iter).set_class(a_class.get_iter());
+	  const_cast<Function&>(*iter).set_class(scope);
       }
       last = (cd_iter == decl.classes.end());
       is_class = true;
       while (!last)
       {
-	if (!first)
-	  scopename += "::";
-	else
-	  first = false;
-	scopename += cd_iter->name();
-	if (cd_iter->has_template_argument_list())
-	  scopename += "<>";
+	scope = Class::scope(scope, decl.symbol(cd_iter->name()), cd_iter->has_template_argument_list());
+	Class const& a_class(*scope);
 	last = (++cd_iter == decl.classes.end());
 #ifdef CWDEBUG
-	Dout(dc::decl, "scopename set to \"" << scopename << "\" (is_class == " << (is_class ? "true" : "false") << ")");
+	Dout(dc::decl, "scopename set to \"" << a_class.base_name() << "\" (is_class == " << (is_class ? "true" : "false") << ")");
 	if (last)
 	  Dout(dc::decl, "This is the last scopename of decl.classes");
-#endif
-	Class const a_class(scopename);
-#ifdef CWDEBUG
         if (!a_class.is_class())
 	  Dout(dc::decl, "Calling set_class() for scopename \"" << a_class.base_name() << "\"");
 #endif
-	const_cast<Class&>(*a_class.get_iter()).set_class();
+	const_cast<Class&>(a_class).set_class();
         if (last)
-	  const_cast<Function&>(*iter).set_class(a_class.get_iter());
+	  const_cast<Function&>(*iter).set_class(scope);
       }
-      if (first)
+      if (scope == Class::container.end())
       {
-        // scopename is empty.
-        Class const a_class(scopename);
+        // The function is in the global namespace.
+        Class const a_class("");
 	const_cast<Function&>(*iter).set_class(a_class.get_iter());
       }
       Debug(libcw_do.dec_indent(2));
     }
+    Function::erase(unparsable);
     size_t classes_size;
     do
     {
@@ -604,6 +757,8 @@ int main(int argc, char* const argv[])
 	const_cast<Class&>(*iter).set_class();
       }
     }
+    if (!checkpoint.empty() && resumed < checkpoint_classes)
+      save_checkpoint(checkpoint, checkpoint_classes, input_options, sample);
     if (verbose)
     {
       std::cout << "done." << std::endl;
@@ -791,8 +946,7 @@ int main(int argc, char* const argv[])
         const_cast<Function&>(*iter).set_project(a_class.get_projects().begin()->first);
         continue;
       }
-      std::string function_name_prefix = iter->decl().function_name.substr(0, 6);
-      if (function_name_prefix == "__cxa_" || function_name_prefix == "__tcf_")
+      if (iter->function_name_starts_with("__cxa_") || iter->function_name_starts_with("__tcf_"))
       {
         const_cast<Function&>(*iter).set_project(gcc_iter);
         continue;
@@ -802,6 +956,10 @@ int main(int argc, char* const argv[])
     if (verbose)
       std::cout << " done." << std::endl;
 
+    //---------------------------------------------------------------------------------------------
+    // From here on, the functions and edges don't change anymore.
+    call_graph.freeze();
+
     //---------------------------------------------------------------------------------------------
     generate_project_graph(verbose);
     generate_class_graph(verbose);
@@ -809,25 +967,26 @@ int main(int argc, char* const argv[])
     //---------------------------------------------------------------------------------------------
     if (verbose)
       std::cout << "Trying to determine which classes are functors..." << std::flush;
-    for (std::set<Edge>::const_iterator iter = Edge::container.begin(); iter != Edge::container.end(); ++iter)
+    for (Functions::iterator iter = Function::container.begin(); iter != Function::container.end(); ++iter)
     {
-      Edge const& edge(*iter);
-      Function const& caller(edge.get_caller());
-      if (!caller.decl().is_template())
+      Function const& caller(*iter);
+      if (!caller.is_template())
         continue;	// Not a functor.
-      Function const& callee(edge.get_callee());
-      Project const& caller_project(caller.get_project());
-      Project const& callee_project(callee.get_project());
-      size_t caller_project_index = caller_project.get_index();
-      size_t callee_project_index = callee_project.get_index();
-      if (caller_project_index == callee_project_index)
-        continue;	// We cannot determine if this is a functor.
-      if (!project_graph.is_connected(caller_project_index, callee_project_index))
+      size_t caller_project_index = caller.get_project().get_index();
+      CallGraph::const_iterator const callees_end = call_graph.callees_end(caller.id());
+      for (CallGraph::const_iterator callee_id = call_graph.callees_begin(caller.id()); callee_id != callees_end; ++callee_id)
       {
-        // Must be an upstream call, and therefore a functor.
-	Class const& a_class(callee.get_class());
-	const_cast<Class&>(a_class).set_functor();
-	// Dout(dc::notice, caller << " (" << caller_project_index << ") calls " << callee << " (" << callee_project_index << ')');
+	Function const& callee(*Function::by_id(*callee_id));
+	size_t callee_project_index = callee.get_project().get_index();
+	if (caller_project_index == callee_project_index)
+	  continue;	// We cannot determine if this is a functor.
+	if (!project_graph.is_connected(caller_project_index, callee_project_index))
+	{
+	  // Must be an upstream call, and therefore a functor.
+	  Class const& a_class(callee.get_class());
+	  const_cast<Class&>(a_class).set_functor();
+	  // Dout(dc::notice, caller << " (" << caller_project_index << ") calls " << callee << " (" << callee_project_index << ')');
+	}
       }
     }
     if (verbose)
@@ -839,6 +998,14 @@ int main(int argc, char* const argv[])
 	  if (iter->is_functor())
 	    std::cout << "  " << iter->base_name() << std::endl;
       }
+      std::ios::fmtflags flags = std::cout.flags();
+      std::streamsize precision = std::cout.precision();
+      Arena const* const arenas[] = { &ingestion_arena, &analysis_arena };
+      for (size_t i = 0; i < sizeof(arenas) / sizeof(arenas[0]); ++i)
+	std::cout << "The " << arenas[i]->name() << " arena used at most " << std::fixed << std::setprecision(1) <<
+	    arenas[i]->high_water_mark() / 1048576.0 << " MB (" << arenas[i]->reserved() / 1048576.0 << " MB reserved)." << std::endl;
+      std::cout.flags(flags);
+      std::cout.precision(precision);
     }
 
     //---------------------------------------------------------------------------------------------
@@ -848,13 +1015,16 @@ int main(int argc, char* const argv[])
     ShortName<FileName::container_type>::initialize_serialization_index();
     DirTree::initialize_serialization_index();
     Directory::initialize_serialization_index();
-    Location::initialize_serialization_index();
     Project::initialize_serialization_index();
     Class::initialize_serialization_index();
     ShortName<Project::container_type>::initialize_serialization_index();
     Function::initialize_serialization_index();
     Edge::initialize_serialization_index();
     save_state("test.xml");
+
+    // The elements are never destroyed (see Arena): return their memory at once.
+    analysis_arena.release();
+    ingestion_arena.release();
   }
   catch (clean_exit const& error)
   {
@@ -882,118 +1052,3 @@ int main(int argc, char* const argv[])
   Dout(dc::always|noprefix_cf|nonewline_cf|flush_cf, "");
   return exit_code;
 }
-
-void process_input_line(
-    char const* line, CGDFile::container_type::iterator cgd_file, int input_line_nr, std::string const& curdir)
-{
-  if (line[0] != 'F' && line[0] != 'C')
-  {
-    std::ostringstream ss;
-    ss << cgd_file->long_name() << ':' << input_line_nr << ": syntax error: Lines are expected to start with either F or C.";
-    THROW_EXCEPTION(std::runtime_error(ss.str()),
-	"process_input_line(\"" << line << "\", \"" << cgd_file->long_name() <<
-	"\", " << input_line_nr << "): Input doesn't start with F or C");
-  }
-  bool parse_error = false;
-  char const* ptr = line;
-  std::string function_str;
-  Functions::iterator caller;
-  for (int field = 0; field < (line[0] == 'F' ? 2 : 4); ++field)
-  {
-    if (ptr[1] != ' ' || ptr[2] != '{')
-    {
-      parse_error = true;
-      break;
-    }
-    int n = 2;
-    while (ptr[++n] && ptr[n] != '}');
-    if (ptr[n] != '}')
-    {
-      parse_error = true;
-      break;
-    }
-    if (field == 0)
-    {
-      function_str.assign(ptr + 3, n - 3);
-      std::string::size_type pos = 0;
-      do
-      {
-	pos = function_str.find("<unnamed>::", pos); 
-	if (pos == std::string::npos)
-	  break;
-        pos += 8;
-	function_str.insert(pos, "@");
-	function_str.insert(pos + 1, cgd_file->short_name());
-      }
-      while(1);
-    }
-    else if (field == 1)
-    {
-      std::string file_name_str(ptr + 3, n - 3);
-      std::string::size_type pos = file_name_str.find(':');
-      if (pos == std::string::npos)
-      {
-        parse_error = true;
-	break;
-      }
-      int line_number = atoi(ptr + 4 + pos);
-      if (line_number == 0)
-      {
-        parse_error = true;
-	break;
-      }
-      file_name_str.erase(pos);
-      bool relative = file_name_str[0] != '/' && file_name_str[0] != '<';
-      if (relative)
-        file_name_str = curdir + "/" + file_name_str;
-      FileName const file_name(file_name_str);
-      Location const location(file_name, line_number);
-      if (line[0] == 'F')	// Declarion and not call location?
-      {
-	if (file_name.is_source_file())
-	  const_cast<CGDFile&>(*cgd_file).set_source_file(file_name);
-        // Add new function declaration.
-	Function const function(function_str, file_name, cgd_file);
-      }
-      else
-      {
-        Function const function(function_str, file_name);
-	caller = function.get_iter();
-      }
-    }
-    else if (field == 2)
-    {
-      function_str.assign(ptr + 3, n - 3);
-      std::string::size_type pos = 0;
-      do
-      {
-	pos = function_str.find("<unnamed>::", pos); 
-	if (pos == std::string::npos)
-	  break;
-        pos += 8;
-	function_str.insert(pos, "@");
-	function_str.insert(pos + 1, cgd_file->short_name());
-      }
-      while(1);
-    }
-    else if (field == 3)
-    {
-      std::string file_name_str(ptr + 3, n - 3);
-      bool relative = file_name_str[0] != '/' && file_name_str[0] != '<';
-      if (relative)
-        file_name_str = curdir + "/" + file_name_str;
-      FileName const file_name(file_name_str);
-      Function const callee(function_str, file_name);
-      const_cast<Function&>(*caller).add_callee(callee);
-    }
-    ptr += n;
-  }
-  if (parse_error)
-  {
-    std::ostringstream ss;
-    ss << cgd_file->long_name() << ':' << input_line_nr << ": Parse error.";
-    THROW_EXCEPTION(std::runtime_error(ss.str()),
-	"process_input_line(\"" << line << "\", \"" << cgd_file->long_name() <<
-	"\", " << input_line_nr << "): Parse error");
-  }
-}
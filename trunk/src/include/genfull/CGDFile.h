@@ -13,6 +13,7 @@
 #define CGDFILE_H
 
 #include <vector>
+#include <stdint.h>
 #include "CGDFileData.h"
 #include "FileName.h"
 
@@ -22,8 +23,40 @@ public:
 
 public:
   void set_source_file(FileName const& source_file) { M_source_file = source_file.get_iter(); }
+  void set_corpus(std::string const& corpus, size_t index) { M_corpus = corpus; M_corpus_index = index; }
 };
 
-void initialize_cgd_files(void);
+// The different kinds of input files.
+enum cgd_format_type {
+  cgd_format_none,		// Not an input file.
+  cgd_format_text,		// .cgd
+  cgd_format_binary,		// .cgdb, see CGDBinary.h
+  cgd_format_gzip,		// .cgd.gz
+  cgd_format_zstd,		// .cgd.zst
+  cgd_format_corpus		// .cgdm, see CGDCorpus.h
+};
+
+// Return the format of the input file 'filename', judging by its suffix.
+cgd_format_type cgd_format(char const* filename);
+
+// A deterministic subset of the input files, see --sample.
+struct CGDSample {
+  double size;			// The fraction (less than 1) or the number of input files to read; 0 means all.
+  uint32_t seed;		// Different seeds select different subsets.
+  size_t found;			// Set by initialize_cgd_files: the number of compilation units found.
+  CGDSample(void) : size(0), seed(0), found(0) { }
+  bool enabled(void) const { return size > 0; }
+};
+
+// Find the input files in the subdirectories and add them, or the sample of them, to CGDFile::container.
+void initialize_cgd_files(int jobs, CGDSample& sample);
+
+// Append the input file 'filename' to CGDFile::container.
+// CGDFile::generate_short_names() still needs to be called after all input files were added.
+CGDFile::container_type::iterator add_cgd_file(std::string const& filename);
+
+// Return the input files that have to be read to get the records of all CGDFiles, in order.
+// A corpus is read in the place of the first of its compilation units, and only once.
+void get_input_files(std::vector<CGDFile::container_type::iterator>& input_files);
 
 #endif // CGDFILE_H
@@ -30,6 +30,11 @@ public:
     M_is_functor = M_iter->M_is_functor;
   }
   
+  // Return the class or namespace 'component', with "<>" appended if it has a template argument list,
+  // in scope 'parent', or in the global namespace if 'parent' is container.end(). It is added when it
+  // doesn't exist yet. Only a first lookup constructs the full name.
+  static Classes::iterator scope(Classes::iterator parent, Symbol component, bool has_template_argument_list);
+
   void set_class(void) { M_is_class = true; }
   void set_parent(void);
   void set_functor(void) { M_is_functor = true; }
@@ -13,8 +13,10 @@
 #define CLASSES_H
 
 #include <set>
+#include <functional>
+#include "Arena.h"
 
 class Class;
-typedef std::set<Class> Classes;
+typedef std::set<Class, std::less<Class>, ArenaAllocator<Class, analysis_arena> > Classes;
 
 #endif // CLASSES_H
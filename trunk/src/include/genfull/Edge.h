@@ -17,12 +17,16 @@
 #include "EdgeData.h"
 #include "Edges.h"
 #include "Functions.h"
+#include "Location.h"
 #include "serialization.h"
 
-class Edge : public EdgeData<Edges, Functions, Function> {
+class Edge : public EdgeData<Edges, Functions, Function, Location> {
 public:
   Edge(Function const& caller, Function const& callee) :
-      EdgeData<Edges, Functions, Function>(caller, callee) { add(container, *this); }
+      EdgeData<Edges, Functions, Function, Location>(caller, callee) { add(container, *this); }
+  // Add the edge right before 'hint', if it belongs there.
+  Edge(Function const& caller, Function const& callee, Edges::iterator hint) :
+      EdgeData<Edges, Functions, Function, Location>(caller, callee) { add(container, hint, *this); }
 };
 
 #endif // EDGE_H
@@ -13,8 +13,10 @@
 #define EDGES_H
 
 #include <set>
+#include <functional>
+#include "Arena.h"
 
 class Edge;
-typedef std::set<Edge> Edges;
+typedef std::set<Edge, std::less<Edge>, ArenaAllocator<Edge, ingestion_arena> > Edges;
 
 #endif // EDGES_H
@@ -14,21 +14,31 @@
 
 #include <string>
 #include <set>
+#include <functional>
+#include "Arena.h"
 #include "FileNameData.h"
 #include "Project.h"
 
-class FileName : public FileNameData<std::set<FileName> > {
+class FileName;
+typedef std::set<FileName, std::less<FileName>, ArenaAllocator<FileName, ingestion_arena> > FileNames;
+
+class FileName : public FileNameData<FileNames> {
 public:
-  FileName(std::string const& filename) : FileNameData<std::set<FileName> >(filename)
+  FileName(std::string const& filename) : FileNameData<FileNames>(filename)
   {
-    if (add(container, *this))
+    // Most filenames were seen before; finding them by symbol doesn't compare any strings.
+    FileName const* known = S_index.find(this->M_KEY_long_name);
+    if (known)
+      this->M_iter = known->get_iter();
+    else if (add(container, *this))
     {
+      S_index.insert(this->M_KEY_long_name, *this->M_iter);
       init_short_name(this->M_iter);
       bool is_source_file = false;
-      std::string::size_type pos = this->M_KEY_long_name.rfind('.');
+      std::string::size_type pos = this->long_name().rfind('.');
       if (pos != std::string::npos)
       {
-	std::string extension = this->M_KEY_long_name.substr(pos);
+	std::string extension = this->long_name().substr(pos);
 	is_source_file =
 	  extension == ".cc" ||
 	  extension == ".cxx" ||
@@ -39,6 +49,7 @@ public:
       const_cast<FileName&>(*this->M_iter).M_is_source_file = is_source_file;
     }
     M_is_source_file = this->M_iter->M_is_source_file;
+    M_id = this->M_iter->M_id;
   }
   void set_project(Project::container_type::iterator project_iter) { M_project = project_iter; }
 };
@@ -13,6 +13,8 @@
 #define FUNCTION_H
 
 #include <string>
+#include <set>
+#include <vector>
 #include "Functions.h"
 #include "CGDFile.h"
 #include "FileName.h"
@@ -27,12 +29,37 @@ public:
   Function(std::string const& function_name, FileName const& filename, CGDFile::container_type::const_iterator cgd_file);
   Function(std::string const& function_name, FileName const& filename) :
       FunctionData<Functions, CGDFile, FileName, Project, Classes, FunctionDecl, Edges>(function_name, filename)
-      { add(container, *this); }
+      { add_to_container(); }
+  // Add the function right before 'hint', if it belongs there.
+  Function(Symbol function_name, FileName const& filename, Functions::iterator hint);
 
   void set_project(Project::container_type::iterator iter) { M_project_iter = iter; }
   void set_class(Classes::iterator iter) { M_class_iter = iter; }
   void add_callee(Function const& callee);
+  // The same, adding the edge right before 'hint' if it belongs there. Returns the (new or existing) edge.
+  Edges::iterator add_callee(Function const& callee, Edges::iterator hint);
   void set_definition(CGDFile::container_type::const_iterator cgd_file) { M_definition = true; M_cgd_file = cgd_file; }
+
+  // Parse the declaration, unless that was done already. Returns false if the name can't be parsed.
+  bool parse_decl(void) const;
+  // The same as decl().is_template(), but only parses the declaration if the name contains a template.
+  bool is_template(void) const;
+  // Returns true if this is a destructor, assignment operator, copy constructor or default constructor.
+  // Only parses the declaration if the name could be one of those.
+  bool is_possibly_compiler_generated(void) const;
+  // Returns true if the function name, without its scope, starts with 'prefix'.
+  // Only parses the declaration if the name contains 'prefix'.
+  bool function_name_starts_with(char const* prefix) const;
+  // The types seen in the declarations that were parsed so far.
+  static std::set<std::string> const& types(void) { return S_types; }
+
+  // Erase functions from container, together with their edges.
+  static void erase(std::vector<Functions::iterator> const& functions);
+
+private:
+  static std::set<std::string> S_types;
+
+  void add_to_container(void);
 };
 
 #endif // FUNCTION_H
@@ -13,8 +13,10 @@
 #define FUNCTIONS_H
 
 #include <set>
+#include <functional>
+#include "Arena.h"
 
 class Function;
-typedef std::set<Function> Functions;
+typedef std::set<Function, std::less<Function>, ArenaAllocator<Function, ingestion_arena> > Functions;
 
 #endif // FUNCTIONS_H
@@ -12,20 +12,50 @@
 #ifndef LOCATION_H
 #define LOCATION_H
 
-#include <set>
-#include "LocationData.h"
+#include <string>
+#include <vector>
+#include <utility>
+#include <stdint.h>
 #include "FileName.h"
+#include "Arena.h"
 
-class Location : public LocationData<std::set<Location>, FileName> {
+// A line in a source file, at which a function is defined or called from.
+//
+// A Location is packed in a single 64 bit key: the id of the FileName in the upper
+// half and the line number in the lower half. Locations are therefore not elements
+// in a set, like the other containers, but values in one sorted array; since the
+// file is the most significant part of the key, that array consists of a sorted
+// table of line numbers per file.
+class Location {
 public:
+  typedef uint64_t key_type;
+  typedef std::vector<Location, ArenaAllocator<Location, ingestion_arena> > container_type;
+
   Location(FileName const& filename, int line_nr) :
-      LocationData<std::set<Location>, FileName>(filename, line_nr) { add(container, *this); }
+      M_key(static_cast<key_type>(filename.id()) << 32 | static_cast<uint32_t>(line_nr)) { }
+  explicit Location(key_type key) : M_key(key) { }
+
+  FileName const& get_file(void) const { return *FileName::by_id(M_key >> 32); }
+  std::string const& filename(void) const { return get_file().long_name(); }
+  int line_nr(void) const { return static_cast<int32_t>(M_key & 0xffffffff); }
+  key_type key(void) const { return M_key; }
+
+  // Orders by file id, then by line number.
+  friend bool operator<(Location loc1, Location loc2) { return loc1.M_key < loc2.M_key; }
+  friend bool operator==(Location loc1, Location loc2) { return loc1.M_key == loc2.M_key; }
+
+  // All locations at which functions are defined or called from, sorted and without duplicates.
+  // Never destroyed, see Arena.
+  static container_type& container;
+
+  // Add 'locations' to container, sorting them with up to 'jobs' threads. 'locations' is cleared.
+  static void add(container_type& locations, int jobs = 1);
+
+  // Return the part of container with the locations in 'file', sorted by line number.
+  static std::pair<container_type::const_iterator, container_type::const_iterator> lines(FileName const& file);
 
-  friend bool operator<(Location const& loc1, Location const& loc2)
-  {
-    return (loc1.M_KEY_line_nr < loc2.M_KEY_line_nr ||
-        (loc1.M_KEY_line_nr == loc2.M_KEY_line_nr && *loc1.M_KEY_filename_ptr < *loc2.M_KEY_filename_ptr));
-  }
+private:
+  key_type M_key;
 };
 
 #endif // LOCATION_H
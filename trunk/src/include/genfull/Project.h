@@ -23,7 +23,7 @@ public:
   Project(DirTree::container_type::iterator const& dirtree_iter) :
       ProjectData<std::set<Project>, DirTree>("", dirtree_iter) { add(container, *this); }
 
-  void generate_long_name(void) { M_KEY_long_name = M_KEY_dirtree->str(); init_short_name(M_iter); }
+  void generate_long_name(void) { M_KEY_long_name = Symbol(M_KEY_dirtree->str()); init_short_name(M_iter); }
 
 private:
   // Serialization.
@@ -44,8 +44,8 @@ void ShortName<Container>::
     Dout(dc::shortname,
         "In ShortName<" << type_info_of<Container>().demangled_name() << ">::"
 	"solve_collisions((" << type_info_of(old_iter).demangled_name() << "&) " << (void*)&old_iter << "): " <<
-	"calling " << type_info_of(**iter).demangled_name() << "::long_name()");
-    std::string const& fullname = (*iter)->long_name();
+	"calling " << type_info_of(**iter).demangled_name() << "::short_name_source()");
+    std::string const& fullname = (*iter)->short_name_source();
     Dout(dc::shortname, "&fullname == " << (void*)&fullname);
     size_t pos = fullname.rfind(Container::value_type::seperator(), fullname.size() - current_len - 2) + 1;
     std::string new_shortname = fullname.substr(pos);
@@ -53,6 +53,6 @@ void ShortName<Container>::
     new_iter = shortname.get_iter();
   }
   const_cast<ShortName<Container>&>(*new_iter).solve_collisions(new_iter);
-  this->container.erase(old_iter++);
+  this->remove(old_iter++);
 }
 
@@ -0,0 +1,100 @@
+// cppgraph -- C++ call graph analyzer
+//
+//! @file parallel_sort.h
+//! @brief This file contains the declaration and implementation of function parallel_sort.
+//
+// Copyright (C) 2006, by Timmy <timmy1992@gmail.com>
+//
+// This file may be distributed under the terms of the Q Public License
+// version 1.0 as appearing in the file LICENSE.QPL included in the
+// packaging of this file.
+
+#ifndef PARALLEL_SORT_H
+#define PARALLEL_SORT_H
+
+#include <algorithm>
+#include <vector>
+#include <pthread.h>
+
+namespace parallel_sort_detail {
+
+// Sorts [first, last), or merges the sorted ranges [first, middle) and [middle, last).
+template<typename RandomAccessIterator, typename Compare>
+struct Task {
+  RandomAccessIterator first;
+  RandomAccessIterator middle;		// Equal to first for a sort.
+  RandomAccessIterator last;
+  Compare comp;
+
+  void run(void)
+  {
+    if (middle == first)
+      std::sort(first, last, comp);
+    else
+      std::inplace_merge(first, middle, last, comp);
+  }
+  static void* start(void* arg) { static_cast<Task*>(arg)->run(); return NULL; }
+};
+
+// Run all tasks in parallel; the last one is run by the calling thread.
+// A task for which no thread can be created is run by the calling thread too.
+template<typename Task>
+void run_tasks(std::vector<Task>& tasks)
+{
+  std::vector<pthread_t> threads(tasks.size() - 1);
+  size_t started = 0;
+  while (started < threads.size() && pthread_create(&threads[started], NULL, &Task::start, &tasks[started]) == 0)
+    ++started;
+  for (size_t index = started; index < tasks.size(); ++index)
+    tasks[index].run();
+  for (size_t index = 0; index < started; ++index)
+    pthread_join(threads[index], NULL);
+}
+
+} // namespace parallel_sort_detail
+
+// Sort [first, last) like std::sort, using up to 'jobs' threads: each thread sorts a
+// part, after which the parts are merged pairwise. 'comp' must be copyable and
+// assignable, and may be called by all threads at the same time.
+template<typename RandomAccessIterator, typename Compare>
+void parallel_sort(RandomAccessIterator first, RandomAccessIterator last, Compare comp, int jobs)
+{
+  typedef parallel_sort_detail::Task<RandomAccessIterator, Compare> task_type;
+  size_t const size = last - first;
+  size_t const min_part = 16384;	// Smaller parts are not worth a thread.
+  size_t parts = std::min(static_cast<size_t>(jobs), size / min_part);
+  if (parts <= 1)
+  {
+    std::sort(first, last, comp);
+    return;
+  }
+  // bounds[i] is the start of part i, and the end of part i - 1.
+  std::vector<RandomAccessIterator> bounds;
+  for (size_t part = 0; part <= parts; ++part)
+    bounds.push_back(first + size * part / parts);
+  std::vector<task_type> tasks;
+  for (size_t part = 0; part < parts; ++part)
+  {
+    task_type const task = { bounds[part], bounds[part], bounds[part + 1], comp };
+    tasks.push_back(task);
+  }
+  parallel_sort_detail::run_tasks(tasks);
+  while (bounds.size() > 2)
+  {
+    tasks.clear();
+    std::vector<RandomAccessIterator> merged_bounds;
+    size_t part = 0;
+    for (; part + 2 < bounds.size(); part += 2)
+    {
+      task_type const task = { bounds[part], bounds[part + 1], bounds[part + 2], comp };
+      tasks.push_back(task);
+      merged_bounds.push_back(bounds[part]);
+    }
+    for (; part < bounds.size(); ++part)
+      merged_bounds.push_back(bounds[part]);
+    parallel_sort_detail::run_tasks(tasks);
+    bounds.swap(merged_bounds);
+  }
+}
+
+#endif // PARALLEL_SORT_H
@@ -16,6 +16,8 @@
 #include <vector>
 #include <set>
 #include <cassert>
+#include <cstring>
+#include <cctype>
 #include "FunctionDecl.h"
 #include "ClassDecl.h"
 #include "debug.h"
@@ -49,20 +51,40 @@ keyword_p(char const* str)
 //------------------------------------------------------------------------------------------------------------------------
 // Functors
 
+inline DeclSlice make_slice(char const* input, char const* first, char const* last)
+{
+  return DeclSlice(first - input, last - first);
+}
+
+// Actor to store the matched input as a slice of the input.
+struct slice_a {
+  slice_a(DeclSlice& slice, char const* const& input) : M_slice(slice), M_input(input) { }
+  void operator()(char const* first, char const* last) const { M_slice = make_slice(M_input, first, last); }
+  DeclSlice& M_slice;
+  char const* const& M_input;
+};
+
+// Actor to add the matched input as a type to a vector of types.
+struct push_back_type_a {
+  push_back_type_a(std::vector<Symbol>& types) : M_types(types) { }
+  void operator()(char const* first, char const* last) const { M_types.push_back(Symbol(first, last - first)); }
+  std::vector<Symbol>& M_types;
+};
+
 // Actor to clear a FunctionDecl object and mark it as constructor.
 struct is_constructor_a {
-  is_constructor_a(FunctionDecl& decl, std::set<std::string>& types) : M_decl(decl), M_types(types) { }
+  is_constructor_a(FunctionDecl& decl, std::vector<DeclSlice>& types) : M_decl(decl), M_types(types) { }
   void operator()(char const*, char const*) const { M_decl.clear(); M_types.clear(); M_decl.set_constructor(); }
   FunctionDecl& M_decl;
-  std::set<std::string>& M_types;
+  std::vector<DeclSlice>& M_types;
 };
 
 // Actor to clear a FunctionDecl object and mark it as destructor.
 struct is_destructor_a {
-  is_destructor_a(FunctionDecl& decl, std::set<std::string>& types) : M_decl(decl), M_types(types) { }
+  is_destructor_a(FunctionDecl& decl, std::vector<DeclSlice>& types) : M_decl(decl), M_types(types) { }
   void operator()(char) const { M_decl.clear(); M_types.clear(); M_decl.set_destructor(); }
   FunctionDecl& M_decl;
-  std::set<std::string>& M_types;
+  std::vector<DeclSlice>& M_types;
 };
 
 struct is_assignment_a {
@@ -78,17 +100,19 @@ struct clear_output_a {
 };
 
 struct class_name_beg_a {
-  class_name_beg_a(ClassDecl& class_decl) : M_class_decl(class_decl) { }
+  class_name_beg_a(ClassDecl& class_decl, char const* const& input) : M_class_decl(class_decl), M_input(input) { }
   void operator()(char const* first, char const* last) const
-      { if (M_class_decl.action_begin()) M_class_decl.set_name(std::string(first, last)); }
+      { if (M_class_decl.action_begin()) M_class_decl.set_name(make_slice(M_input, first, last)); }
   ClassDecl& M_class_decl;
+  char const* const& M_input;
 };
 
 struct template_argument_list_a {
-  template_argument_list_a(ClassDecl& class_decl) : M_class_decl(class_decl) { }
+  template_argument_list_a(ClassDecl& class_decl, char const* const& input) : M_class_decl(class_decl), M_input(input) { }
   void operator()(char const* first, char const* last) const
-      { if (M_class_decl.action_end()) M_class_decl.set_template_argument_list(std::string(first, last)); }
+      { if (M_class_decl.action_end()) M_class_decl.set_template_argument_list(make_slice(M_input, first, last)); }
   ClassDecl& M_class_decl;
+  char const* const& M_input;
 };
 
 struct class_name_end_a {
@@ -98,11 +122,13 @@ struct class_name_end_a {
 };
 
 struct nested_class_name_a {
-  nested_class_name_a(std::set<std::string>& types, char const*& last) : M_types(types), M_last(last) { }
+  nested_class_name_a(std::vector<DeclSlice>& types, char const*& last, char const* const& input) :
+      M_types(types), M_last(last), M_input(input) { }
   void operator()(char const* first, char const*) const
-      { if (M_last) M_types.insert(std::string(first, M_last)); M_last = NULL; }
-  std::set<std::string>& M_types;
+      { if (M_last) M_types.push_back(make_slice(M_input, first, M_last)); M_last = NULL; }
+  std::vector<DeclSlice>& M_types;
   char const*& M_last;
+  char const* const& M_input;
 };
 
 struct store_last_a {
@@ -111,23 +137,30 @@ struct store_last_a {
   char const*& M_last;
 };
 
+// Actor to remove all types that are equal to 'identifier'.
 struct erase_a {
-  erase_a(std::set<std::string>& types, std::string& identifier) : M_types(types), M_identifier(identifier) { }
+  erase_a(std::vector<DeclSlice>& types, DeclSlice& identifier, char const* const& input) :
+      M_types(types), M_identifier(identifier), M_input(input) { }
   void operator()(char) const
       {
-        std::set<std::string>::iterator iter = M_types.find(M_identifier);
-	if (iter != M_types.end())	// g++ is stupid
-	  M_types.erase(iter);
+	std::vector<DeclSlice>::iterator out = M_types.begin();
+	for (std::vector<DeclSlice>::iterator iter = M_types.begin(); iter != M_types.end(); ++iter)
+	  if (iter->length != M_identifier.length ||
+	      std::memcmp(M_input + iter->offset, M_input + M_identifier.offset, M_identifier.length) != 0)
+	    *out++ = *iter;
+	M_types.erase(out, M_types.end());
       }
-  std::set<std::string>& M_types;
-  std::string& M_identifier;
+  std::vector<DeclSlice>& M_types;
+  DeclSlice& M_identifier;
+  char const* const& M_input;
 };
  
 struct returns_function_pointer_a {
-  returns_function_pointer_a(FunctionDecl& decl) : M_decl(decl) { }
+  returns_function_pointer_a(FunctionDecl& decl, char const* const& input) : M_decl(decl), M_input(input) { }
   void operator()(char const* first, char const* last) const
-      { M_decl.function_pointer = std::string(first, last); }
+      { M_decl.function_pointer = make_slice(M_input, first, last); }
   FunctionDecl& M_decl;
+  char const* const& M_input;
 };
 
 struct is_template_a {
@@ -137,69 +170,56 @@ struct is_template_a {
 };
 
 struct is_C_function_a {
-  is_C_function_a(FunctionDecl& decl) : M_decl(decl) { }
+  is_C_function_a(FunctionDecl& decl, char const* const& input) : M_decl(decl), M_input(input) { }
   void operator()(char const* first, char const* last) const
-      { M_decl.set_is_C_function(); M_decl.function_name = std::string(first, last); }
+      { M_decl.set_is_C_function(); M_decl.function_name = make_slice(M_input, first, last); }
   FunctionDecl& M_decl;
+  char const* const& M_input;
 };
 
+// Actor to turn the function parsed so far into a scope: it is followed by "::" at 'first'.
 struct function_scope_a {
-  function_scope_a(FunctionDecl& decl) : M_decl(decl) { }
-  void operator()(char const*, char const*) const;
+  function_scope_a(FunctionDecl& decl, char const* const& input) : M_decl(decl), M_input(input) { }
+  void operator()(char const* first, char const*) const;
   FunctionDecl& M_decl;
+  char const* const& M_input;
 };
 
-void function_scope_a::operator()(char const*, char const*) const
+void function_scope_a::operator()(char const* first, char const*) const
 {
-  std::string function_scope = M_decl.function_name;
-  function_scope += '(';
-  bool first = true;
-  for (std::vector<std::string>::const_iterator iter = M_decl.parameter_types.begin();
-       iter != M_decl.parameter_types.end(); ++iter)
-  {
-    if (first)
-      first = false;
-    else
-      function_scope += ", ";
-    function_scope += *iter;
-  }
-  function_scope += ')';
-  if (!M_decl.function_qualifiers.empty())
-  {
-    function_scope += ' ';
-    function_scope += M_decl.function_qualifiers;
-  }
-  if (!M_decl.exception_specification.empty())
-  {
-    function_scope += ' ';
-    function_scope += M_decl.exception_specification;
-  }
-  ClassDecl class_decl(function_scope);
+  // The scope is everything from the function name up to the "::", for example "f(int) const".
+  char const* function_scope_begin = M_input + M_decl.function_name.offset;
+  char const* function_scope_end = first;
+  while (function_scope_end > function_scope_begin && std::isspace(function_scope_end[-1]))
+    --function_scope_end;
+  ClassDecl class_decl(make_slice(M_input, function_scope_begin, function_scope_end));
   class_decl.set_is_function();
   M_decl.classes.push_back(class_decl);
-  M_decl.function_name.clear();
+  M_decl.function_name = DeclSlice();
   M_decl.parameter_types.clear();
-  M_decl.function_qualifiers.clear();
-  M_decl.exception_specification.clear();
+  M_decl.function_qualifiers = DeclSlice();
+  M_decl.exception_specification = DeclSlice();
 }
 
 //------------------------------------------------------------------------------------------------------------------------
 // Grammars
 
 struct FUNCTIONDECLARATION : grammar<FUNCTIONDECLARATION> {
-private:
-  FunctionDecl& M_function_decl;
-  std::set<std::string>& M_types;
-
 public:
-  FUNCTIONDECLARATION(FunctionDecl& function_decl, std::set<std::string>& types) :
-      M_function_decl(function_decl), M_types(types)
+  // The result of the last parse, and the types that it saw; they refer to M_input.
+  // The grammar is meant to be reused, so that the rules are only constructed once
+  // and these vectors keep their capacity.
+  mutable FunctionDecl M_function_decl;
+  mutable std::vector<DeclSlice> M_types;
+  mutable char const* M_input;
+
+  FUNCTIONDECLARATION(void) : M_input(NULL)
   {
     BOOST_SPIRIT_DEBUG_TRACE_GRAMMAR_NAME(*this, "FUNCTIONDECLARATION", 1);
   }
 
 private:
-  mutable std::string M_last_match;
+  mutable DeclSlice M_last_match;
   mutable ClassDecl M_last_class;
   mutable char const* M_last;
 
@@ -291,14 +311,14 @@ public:
 		(
 		    identifier
 		    >> end_p	
-		)						[is_C_function_a(self.M_function_decl)]
+		)						[is_C_function_a(self.M_function_decl, self.M_input)]
 
-	    |   *decl_specifier_no_type				[assign_a(self.M_function_decl.decl_specifier)]
+	    |   *decl_specifier_no_type				[slice_a(self.M_function_decl.decl_specifier, self.M_input)]
 		>>  (
 			(
 			    (
 			       !(
-				    type_id			[assign_a(self.M_function_decl.return_type)]
+				    type_id			[slice_a(self.M_function_decl.return_type, self.M_input)]
 				    >>  (   
 					    (   
 						(
@@ -325,7 +345,7 @@ public:
 				            >> ')'
 				            >> !cv_qualifiers
 				            >> !exception_specification
-					)			[returns_function_pointer_a(self.M_function_decl)]
+					)			[returns_function_pointer_a(self.M_function_decl, self.M_input)]
 				    )
 			        |   decl_without_return_type
 			        )
@@ -351,7 +371,7 @@ public:
 		// Optional namespaces.
 		// Preceding '::' are never printed by gcc, which is why
 		// we can distinguish the function Foo Bar::Bar() from the constructor Foo::Bar::Bar().
-		   *(   (namespace_name		[assign_a(self.M_last_match)]
+		   *(   (namespace_name		[slice_a(self.M_last_match, self.M_input)]
 			    >> "::")		[push_back_a(self.M_function_decl.class_or_namespaces, self.M_last_match)]
 		    )
 		    >> decl_without_return_type_no_namespace
@@ -366,7 +386,7 @@ public:
 		    )	
 
 		// Function name; template parameters are not printed by g++, not even for template (member) functions.
-		    >> unqualified_id		[assign_a(self.M_function_decl.function_name)]
+		    >> unqualified_id		[slice_a(self.M_function_decl.function_name, self.M_input)]
 
 		// Parameter list.
 		    >> '('
@@ -374,17 +394,17 @@ public:
 		    >>  (
 
 			// Just an epsilon (...).
-			    str_p("...")		[push_back_a(self.M_function_decl.parameter_types)]
+			    str_p("...")		[push_back_type_a(self.M_function_decl.parameter_types)]
 
 			// Or a comma separated list of types.
 
-			|   (   type_id			[push_back_a(self.M_function_decl.parameter_types)]
+			|   (   type_id			[push_back_type_a(self.M_function_decl.parameter_types)]
 				>> *(   ','
-					>> type_id	[push_back_a(self.M_function_decl.parameter_types)]
+					>> type_id	[push_back_type_a(self.M_function_decl.parameter_types)]
 				    )
 			    // Possibly followed by an epsilon (with or without comma).
 				>> !(  !ch_p(',')
-					>> str_p("...")	[push_back_a(self.M_function_decl.parameter_types)]
+					>> str_p("...")	[push_back_type_a(self.M_function_decl.parameter_types)]
 				    )
 			    )
 
@@ -395,12 +415,12 @@ public:
 			)
 
 		    >> ')'
-		    >> !cv_qualifiers			[assign_a(self.M_function_decl.function_qualifiers)]
-		    >> !exception_specification		[assign_a(self.M_function_decl.exception_specification)]
+		    >> !cv_qualifiers			[slice_a(self.M_function_decl.function_qualifiers, self.M_input)]
+		    >> !exception_specification		[slice_a(self.M_function_decl.exception_specification, self.M_input)]
 		    // If the function is followed by "::" then it wasn't the real function yet.
 		    >> !(
 			    // Erase parameter_types and continue parsing and recursively continue with parsing classes.
-		            str_p("::")			[function_scope_a(self.M_function_decl)]
+		            str_p("::")			[function_scope_a(self.M_function_decl, self.M_input)]
 			    >> decl_without_return_type_no_namespace
 			)
             ;
@@ -418,25 +438,25 @@ public:
         template_parameter_assignment
 	    =
 	        // First attempt to match identifier >> '=', because in by far most cases there won't be a type here.
-	        identifier		[assign_a(self.M_last_match)]
-		>> ch_p('=')		[erase_a(self.M_types, self.M_last_match)]
+	        identifier		[slice_a(self.M_last_match, self.M_input)]
+		>> ch_p('=')		[erase_a(self.M_types, self.M_last_match, self.M_input)]
 		>> type_id
 	    |   type_id
-	        >> ( identifier | "<anonymous>" )	[assign_a(self.M_last_match)]
-		>> ch_p('=')		[erase_a(self.M_types, self.M_last_match)]
+	        >> ( identifier | "<anonymous>" )	[slice_a(self.M_last_match, self.M_input)]
+		>> ch_p('=')		[erase_a(self.M_types, self.M_last_match, self.M_input)]
 		>> template_argument_literal
 	    ;
 
         class_name
 	    =
 	        // (template_id | identifier), but then smarter and storing the result.
-	            identifier				[class_name_beg_a(self.M_last_class)]
+	            identifier				[class_name_beg_a(self.M_last_class, self.M_input)]
 		    >> !(
 			    (
 				(   ch_p('<')
 				    >> !template_argument_list
 				    >> '>'
-				)   			[template_argument_list_a(self.M_last_class)]
+				)   			[template_argument_list_a(self.M_last_class, self.M_input)]
 			    // If there is no template_argument_list, mark here that we reached the end of class_name.
 			    |   (   epsilon_p		[class_name_end_a(self.M_last_class)]
 				// Fail, otherwise this block will eat spaces anyway.
@@ -670,7 +690,7 @@ public:
 
         nested_class_name_no_template
 	    =
-	        nested_class_name_no_template_tail_recursion  [nested_class_name_a(self.M_types, self.M_last)]
+	        nested_class_name_no_template_tail_recursion  [nested_class_name_a(self.M_types, self.M_last, self.M_input)]
             ;
 
 	nested_class_name_tail_recursion
@@ -684,7 +704,7 @@ public:
 
         nested_class_name
 	    =
-	        nested_class_name_tail_recursion	[nested_class_name_a(self.M_types, self.M_last)]
+	        nested_class_name_tail_recursion	[nested_class_name_a(self.M_types, self.M_last, self.M_input)]
             ;
 
 	parameter_declaration_clause
@@ -835,34 +855,46 @@ public:
 
 bool parse_function_declaration(std::string const& input, FunctionDecl& decl, std::set<std::string>& types)
 {
-  std::set<std::string> decl_types;
-  FUNCTIONDECLARATION grammar(decl, decl_types);
+  static FUNCTIONDECLARATION grammar;
+  // The types that were added to 'types' already, indexed by the id of their symbol.
+  static std::vector<bool> known_types;
+  FunctionDecl& result(grammar.M_function_decl);
+  result.reset(input);
+  grammar.M_types.clear();
+  grammar.M_input = input.c_str();
   boost::spirit::parse_info<> info = boost::spirit::parse(input.c_str(), grammar, boost::spirit::space_p);
   if (info.full)
   {
-    if (decl.is_assignment())
+    if (result.is_assignment())
     {
       // Only keep member functions marked as 'assignment' when they take a parameter of the same type as the class.
-      if (decl.parameter_types.size() != 1 || decl.self_const_reference() != decl.parameter_types.front())
-        decl.unset_assignment();
+      if (result.parameter_types.size() != 1 || result.self_const_reference() != result.parameter_types.front().str())
+        result.unset_assignment();
     }
-    else if (decl.is_constructor())
+    else if (result.is_constructor())
     {
-      if (decl.parameter_types.size() == 1 && decl.self_const_reference() == decl.parameter_types.front())
-        decl.set_copy();
-      if (decl.parameter_types.size() == 0)
-        decl.set_default();
+      if (result.parameter_types.size() == 1 && result.self_const_reference() == result.parameter_types.front().str())
+        result.set_copy();
+      if (result.parameter_types.size() == 0)
+        result.set_default();
     }
     // Add found types to global set of types.
-    for (std::set<std::string>::iterator iter = decl_types.begin(); iter != decl_types.end(); ++iter)
+    for (std::vector<DeclSlice>::iterator iter = grammar.M_types.begin(); iter != grammar.M_types.end(); ++iter)
     {
+      Symbol const type(input.data() + iter->offset, iter->length);
+      if (type.id() < known_types.size() && known_types[type.id()])
+        continue;
+      if (type.id() >= known_types.size())
+        known_types.resize(type.id() + 1);
+      known_types[type.id()] = true;
 #ifndef CWDEBUG
-      types.insert(*iter);
+      types.insert(type.str());
 #else
-      if (types.insert(*iter).second)
-        Dout(dc::decl, "Adding type \"" << *iter << '"');
+      if (types.insert(type.str()).second)
+        Dout(dc::decl, "Adding type \"" << type.str() << '"');
 #endif
     }
+    decl = result;
   }
   return info.full;
 }
@@ -895,50 +927,50 @@ int main(int argc, char* argv[])
   std::string result;
   if (!decl.decl_specifier.empty())
   {
-    result = decl.decl_specifier;
+    result = decl.str(decl.decl_specifier);
     result += ' ';
-    std::cout << "DECL SPECIFIER     : " << decl.decl_specifier << '\n';
+    std::cout << "DECL SPECIFIER     : " << decl.str(decl.decl_specifier) << '\n';
   }
   if (!decl.return_type.empty())
   {
-    result = decl.return_type;
+    result = decl.str(decl.return_type);
     result += ' ';
-    std::cout << "RETURN TYPE        : " << decl.return_type;
+    std::cout << "RETURN TYPE        : " << decl.str(decl.return_type);
     if (!decl.function_pointer.empty())
     {
-      std::cout << " (*" << decl.function_pointer;
+      std::cout << " (*" << decl.str(decl.function_pointer);
       result += "(* ";
     }
     std::cout << '\n';
   }
-  for (std::vector<std::string>::const_iterator iter = decl.class_or_namespaces.begin();
+  for (std::vector<DeclSlice>::const_iterator iter = decl.class_or_namespaces.begin();
        iter != decl.class_or_namespaces.end(); ++iter)
   {
-    result += *iter;
+    decl.append(result, *iter);
     result += "::";
-    std::cout << "CLASS OR NAMESPACE : " << *iter << "::\n";
+    std::cout << "CLASS OR NAMESPACE : " << decl.str(*iter) << "::\n";
   }
   for (std::vector<ClassDecl>::const_iterator iter = decl.classes.begin(); iter != decl.classes.end(); ++iter)
   {
-    result += iter->name();
-    std::cout << "CLASS NAME         : " << iter->name();
+    decl.append(result, iter->name());
+    std::cout << "CLASS NAME         : " << decl.str(iter->name());
     if (iter->has_template_argument_list())
     {
-      result += iter->template_argument_list();
-      std::cout << "\n                   :     " << iter->template_argument_list();
+      decl.append(result, iter->template_argument_list());
+      std::cout << "\n                   :     " << decl.str(iter->template_argument_list());
     }
     std::cout << "::\n";
     result += "::";
   }
-  std::cout << "FUNCTION NAME      : " << decl.function_name << "(\n";
-  result += decl.function_name;
+  std::cout << "FUNCTION NAME      : " << decl.str(decl.function_name) << "(\n";
+  decl.append(result, decl.function_name);
   result += '(';
-  for (std::vector<std::string>::const_iterator iter = decl.parameter_types.begin(); iter != decl.parameter_types.end();)
+  for (std::vector<Symbol>::const_iterator iter = decl.parameter_types.begin(); iter != decl.parameter_types.end();)
   {
-    std::vector<std::string>::const_iterator current = iter++;
+    std::vector<Symbol>::const_iterator current = iter++;
     bool last = iter == decl.parameter_types.end();
-    std::cout << "PARAMETER          : " << *current;
-    result += *current;
+    std::cout << "PARAMETER          : " << current->str();
+    result += current->str();
     if (!last)
     {
       std::cout << ", ";
@@ -950,18 +982,18 @@ int main(int argc, char* argv[])
   result += ')';
   if (!decl.function_qualifiers.empty())
   {
-    std::cout << "QUALIFIERS         : " << decl.function_qualifiers << '\n';
+    std::cout << "QUALIFIERS         : " << decl.str(decl.function_qualifiers) << '\n';
     result += ' ';
-    result += decl.function_qualifiers;
+    decl.append(result, decl.function_qualifiers);
   }
   if (!decl.exception_specification.empty())
   {
-    std::cout << "EXCEPTION SPECIFIER: " << decl.exception_specification << '\n';
+    std::cout << "EXCEPTION SPECIFIER: " << decl.str(decl.exception_specification) << '\n';
     result += ' ';
-    result += decl.exception_specification;
+    decl.append(result, decl.exception_specification);
   }
   if (!decl.function_pointer.empty())
-    result += decl.function_pointer;
+    decl.append(result, decl.function_pointer);
   if (input != result)
   {
     std::cout << "\ninput  = \"" << input << "\".\n";
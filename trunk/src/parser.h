@@ -15,7 +15,9 @@
 #include <set>
 #include "FunctionDecl.h"
 
-// Returns true when 'input' could be successfully parsed. The result is written to 'decl'.
+// Returns true when 'input' could be successfully parsed. The result is written to 'decl',
+// which refers to 'input': that must not move or change as long as 'decl' is used.
+// The types seen in 'input' are added to 'types', which must be the same set on every call.
 bool parse_function_declaration(std::string const& input, FunctionDecl& decl, std::set<std::string>& types);
 
 #endif // PARSER_H
@@ -0,0 +1,831 @@
+// cppgraph -- C++ call graph analyzer
+//
+//! @file read_cgd_files.cc
+//! @brief This file contains the implementation of function read_cgd_files.
+//
+// Copyright (C) 2006, by Timmy <timmy1992@gmail.com>
+//
+// This file may be distributed under the terms of the Q Public License
+// version 1.0 as appearing in the file LICENSE.QPL included in the
+// packaging of this file.
+
+#include "sys.h"
+#include <iostream>
+#include <vector>
+#include <string>
+#include <cstring>
+#include <sstream>
+#include <memory>
+#include <set>
+#include <map>
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <stdint.h>
+#include <pthread.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include "InputReader.h"
+#include "MappedFile.h"
+#include "CGDRecord.h"
+#include "CGDBinary.h"
+#include "Decompressor.h"
+#include "CGDFile.h"
+#include "RecordFilter.h"
+#include "Function.h"
+#include "collapsedpath.h"
+#include "content_hash.h"
+#include "read_cgd_files.h"
+#include "exceptions.h"
+#include "debug.h"
+
+namespace {
+
+// What is needed to process a byte-identical copy of an input file without parsing it.
+//
+// Applying the records of a copy again only changes the cgd file that the defined
+// functions were last seen in, and the source file of the copy: all filenames,
+// locations, functions and edges already exist. The exceptions are anonymous
+// namespaces, that are unique per cgd file, and relative paths, that are relative
+// to the directory of the copy.
+struct Contents {
+  size_t index;					// The index of the first input file with these contents.
+  CGDFile::container_type::iterator cgd_file;	// That input file.
+  std::string curdir;				// The directory containing it.
+  bool done;					// Set when the file was parsed; the next three members are complete.
+  size_t records;				// The number of records.
+  std::set<std::string> relative_paths;		// The relative paths, as they appear in the file.
+  std::vector<CGDRecord> anonymous;		// The records with an anonymous namespace, as they appear in the file.
+  std::vector<CGDRecord::function_id> definitions;	// The other defined functions; complete when the file was applied.
+
+  Contents(void) : index(0), done(false), records(0) { }
+
+  // Return true if record contains an anonymous namespace, before or after CGDRecord::rewrite_unnamed.
+  static bool is_anonymous(CGDRecord const& record)
+  {
+    return record.function.find("<unnamed") != std::string::npos ||
+        (record.type == 'C' && record.callee.find("<unnamed") != std::string::npos);
+  }
+
+  // Add a record, as returned by CGDRecord::parse_raw.
+  void add(CGDRecord const& raw_record);
+
+  // Return true if the relative paths resolve to the same files from other_curdir.
+  bool same_paths(std::string const& other_curdir) const;
+
+  // Do what applying all records to 'copy' would do, that wasn't already done by applying them to cgd_file.
+  // Returns the number of records that were excluded by 'filter'.
+  size_t replay(CGDFile::container_type::iterator copy, RecordFilter const& filter) const;
+};
+
+void Contents::add(CGDRecord const& raw_record)
+{
+  ++records;
+  bool is_call = raw_record.type == 'C';
+  if (CGDRecord::is_relative(raw_record.file))
+    relative_paths.insert(raw_record.file);
+  if (is_call && CGDRecord::is_relative(raw_record.callee_file))
+    relative_paths.insert(raw_record.callee_file);
+  if (is_anonymous(raw_record))
+  {
+    anonymous.push_back(raw_record);
+    if (!is_call)
+    {
+      anonymous.back().callee.clear();
+      anonymous.back().callee_file.clear();
+    }
+  }
+}
+
+bool Contents::same_paths(std::string const& other_curdir) const
+{
+  if (other_curdir == curdir)
+    return true;
+  // FileName collapses absolute paths, so for example "../src/foo.cc" is the same
+  // file when read from /build/debug/lib and /build/release/lib.
+  for (std::set<std::string>::const_iterator iter = relative_paths.begin(); iter != relative_paths.end(); ++iter)
+    if (collapsedpath(curdir + "/" + *iter) != collapsedpath(other_curdir + "/" + *iter))
+      return false;
+  return true;
+}
+
+size_t Contents::replay(CGDFile::container_type::iterator copy, RecordFilter const& filter) const
+{
+  CGDRecord record;
+  size_t excluded = 0;
+  for (std::vector<CGDRecord>::const_iterator iter = anonymous.begin(); iter != anonymous.end(); ++iter)
+  {
+    record = *iter;
+    if (filter.excludes(record, copy->directory().str()))
+    {
+      ++excluded;
+      continue;
+    }
+    record.resolve_functions(*copy);
+    record.apply(copy);
+  }
+  for (std::vector<CGDRecord::function_id>::const_iterator iter = definitions.begin(); iter != definitions.end(); ++iter)
+    CGDRecord::set_definition(*iter, copy);
+  if (cgd_file->has_source_file())
+    copy->set_source_file(cgd_file->source_file());
+  return excluded;
+}
+
+// Return true if the file 'filename' contains exactly [begin, begin + size).
+bool same_contents(std::string const& filename, char const* begin, size_t size)
+{
+  try
+  {
+    MappedFile const original(filename);
+    return original.size() == size && (size == 0 || std::memcmp(original.begin(), begin, size) == 0);
+  }
+  catch (std::runtime_error const&)
+  {
+    return false;		// Then just parse the copy.
+  }
+}
+
+// Recognizes input files with the same contents as an earlier input file.
+class DuplicateFilter {
+private:
+  typedef std::pair<uint64_t, size_t> key_type;	// The hash and the size of the contents.
+  std::map<key_type, Contents> M_contents;
+  pthread_mutex_t* M_mutex;			// Protects M_contents, or NULL when it is used by one thread only.
+  pthread_cond_t* M_cond;			// Signalled when a Contents is done.
+
+public:
+  DuplicateFilter(pthread_mutex_t* mutex, pthread_cond_t* cond) : M_mutex(mutex), M_cond(cond) { }
+
+  // Look up [begin, begin + size), the contents of input file number index, cgd_file.
+  // Returns an earlier input file with the same contents, if the records of cgd_file resolve to
+  // the same paths. Otherwise returns NULL and sets first to where the contents of cgd_file
+  // must be collected, if this is the first input file with these contents, or NULL.
+  Contents const* find(size_t index, CGDFile::container_type::iterator cgd_file, char const* begin, size_t size, Contents*& first);
+
+  // Call this when 'first', as returned by find, was parsed (or failed to parse).
+  void done(Contents* first);
+};
+
+Contents const* DuplicateFilter::find(size_t index, CGDFile::container_type::iterator cgd_file,
+    char const* begin, size_t size, Contents*& first)
+{
+  std::string curdir(cgd_file->long_name(), 0, cgd_file->long_name().rfind('/'));
+  key_type key(content_hash(begin, size), size);
+  Contents const* original = NULL;
+  first = NULL;
+  if (M_mutex)
+    pthread_mutex_lock(M_mutex);
+  std::pair<std::map<key_type, Contents>::iterator, bool> result =
+      M_contents.insert(std::pair<key_type, Contents>(key, Contents()));
+  Contents& contents(result.first->second);
+  if (result.second)
+  {
+    contents.index = index;
+    contents.cgd_file = cgd_file;
+    contents.curdir = curdir;
+    first = &contents;
+  }
+  else if (contents.index < index)	// With more than one thread, a later file might have been found first.
+  {
+    while (!contents.done)
+      pthread_cond_wait(M_cond, M_mutex);
+    if (contents.same_paths(curdir))
+      original = &contents;
+  }
+  if (M_mutex)
+    pthread_mutex_unlock(M_mutex);
+  // The hashes and the sizes can be equal by accident: compare the contents themselves.
+  if (original && !same_contents(original->cgd_file->input_file(), begin, size))
+    original = NULL;
+  return original;
+}
+
+void DuplicateFilter::done(Contents* first)
+{
+  if (M_mutex)
+    pthread_mutex_lock(M_mutex);
+  first->done = true;
+  if (M_mutex)
+  {
+    pthread_cond_broadcast(M_cond);
+    pthread_mutex_unlock(M_mutex);
+  }
+}
+
+// What for_each_record found out about an input file.
+struct InputFile {
+  size_t bytes;			// The size of the file.
+  size_t excluded;		// The number of records that were excluded by the RecordFilter.
+  Contents* first;		// Where the contents of the file are collected, or NULL.
+  Contents const* original;	// The earlier input file that this is a copy of, or NULL.
+  InputFile(void) : bytes(0), excluded(0), first(NULL), original(NULL) { }
+};
+
+// Parses lines of a text input file and calls handler(record) for each record that is not excluded.
+// In a corpus, handler.set_cgd_file(unit) is called at the start of the records of every unit.
+template<class Handler>
+class LineParser {
+private:
+  CGDFile::container_type::iterator M_cgd_file;
+  std::vector<CGDFile::container_type::iterator> const* M_units;	// The units of a corpus, or NULL.
+  std::string const& M_filename;
+  Handler& M_handler;
+  RecordFilter const& M_filter;
+  InputFile& M_input_file;
+  int M_line_nr;
+  CGDRecord M_record;		// Reused for every line.
+  std::string M_buffer;		// Scratch space for CGDRecord::resolve_functions.
+
+public:
+  LineParser(CGDFile::container_type::iterator cgd_file, std::vector<CGDFile::container_type::iterator> const* units,
+      Handler& handler, RecordFilter const& filter, InputFile& input_file) :
+      M_cgd_file(cgd_file), M_units(units), M_filename(cgd_file->input_file()), M_handler(handler), M_filter(filter),
+      M_input_file(input_file), M_line_nr(0) { }
+
+  void operator()(char const* line, size_t len)
+  {
+    ++M_line_nr;
+    if (M_units && len > 0 && line[0] == '#')
+    {
+      section(std::string(line, len));
+      return;
+    }
+    M_record.parse_raw(line, len, M_filename, M_line_nr);
+    if (M_input_file.first)
+      M_input_file.first->add(M_record);
+    if (M_filter.excludes(M_record, M_cgd_file->directory().str()))
+    {
+      ++M_input_file.excluded;
+      return;
+    }
+    M_record.resolve_functions(*M_cgd_file, M_buffer);
+    M_handler(M_record);
+  }
+
+private:
+  // Process a line of a corpus that is not a record. Only "#section" lines matter here; see CGDCorpus.h.
+  void section(std::string const& line)
+  {
+    if (line.compare(0, 9, "#section ") != 0)
+      return;
+    char* number_end;
+    unsigned long unit = strtoul(line.c_str() + 9, &number_end, 10);
+    if (number_end == line.c_str() + 9 || *number_end || unit >= M_units->size())
+    {
+      std::ostringstream ss;
+      ss << M_filename << ':' << M_line_nr << ": syntax error: Invalid section.";
+      THROW_EXCEPTION(std::runtime_error(ss.str()), "LineParser::section(\"" << line << "\")");
+    }
+    M_cgd_file = (*M_units)[unit];
+    M_handler.set_cgd_file(M_cgd_file);
+  }
+};
+
+// Call parser(line, len) for every line in [begin, end).
+// The last line does not need to end on a newline.
+template<class Parser>
+void split_lines(char const* begin, char const* end, Parser& parser)
+{
+  for (char const* line = begin; line < end;)
+  {
+    char const* eol = static_cast<char const*>(memchr(line, '\n', end - line));
+    if (!eol)
+      eol = end;
+    parser(line, eol - line);
+    line = eol + 1;
+  }
+}
+
+// Decompress the input one chunk at a time and call parser(line, len) for every line.
+template<class Parser>
+void split_lines(Decompressor& input, Parser& parser)
+{
+  static size_t const chunk_size = 65536;
+  std::vector<char> chunk(chunk_size);
+  std::string partial_line;	// The beginning of a line that continues in the next chunk.
+  size_t len;
+  while ((len = input.read(&chunk[0], chunk_size)) > 0)
+  {
+    char const* line = &chunk[0];
+    char const* const end = line + len;
+    for(;;)
+    {
+      char const* eol = static_cast<char const*>(memchr(line, '\n', end - line));
+      if (!eol)
+      {
+	partial_line.append(line, end - line);
+	break;
+      }
+      if (partial_line.empty())
+	parser(line, eol - line);
+      else
+      {
+	partial_line.append(line, eol - line);
+	parser(partial_line.data(), partial_line.size());
+	partial_line.clear();
+      }
+      line = eol + 1;
+    }
+  }
+  if (!partial_line.empty())
+    parser(partial_line.data(), partial_line.size());
+}
+
+// Call handler(record) for every record of cgd_file, file number 'index' of 'reader', that is not
+// excluded by 'filter', unless 'duplicates' finds that it is a copy of an earlier input file.
+// The members of input_file are set before the first call to handler, except 'excluded'.
+template<class Handler>
+void for_each_record(InputReader& reader, size_t index, CGDFile::container_type::iterator cgd_file,
+    DuplicateFilter& duplicates, RecordFilter const& filter, Handler& handler, InputFile& input_file)
+{
+  char const* begin;
+  size_t size;
+  reader.get(index, begin, size);
+  input_file.bytes = size;
+  Contents*& first(input_file.first);
+  try
+  {
+    cgd_format_type format = cgd_format(cgd_file->input_file().c_str());
+    // The records of a corpus are already unique.
+    if (format != cgd_format_corpus)
+      input_file.original = duplicates.find(index, cgd_file, begin, size, first);
+    if (input_file.original)
+      ;
+    else if (format == cgd_format_binary)
+    {
+      CGDBinaryReader input(begin, size, *cgd_file);
+      CGDRecord record;
+      CGDRecord raw_record;
+      bool const need_raw = first || !filter.empty();
+      for (size_t i = 0; i < input.size(); ++i)
+      {
+	input.get(i, record);
+	// The paths in a .cgdb file are already absolute; only anonymous namespaces are rewritten.
+	CGDRecord const* raw = &record;
+	if (need_raw && Contents::is_anonymous(record))
+	{
+	  input.get(i, raw_record, true);
+	  raw = &raw_record;
+	}
+	if (first)
+	  first->add(*raw);
+	if (filter.excludes(*raw, cgd_file->directory().str()))
+	  ++input_file.excluded;
+	else
+	  handler(record);
+      }
+    }
+    else if (format == cgd_format_corpus)
+    {
+      // The compilation units of a corpus directly follow the first one.
+      std::vector<CGDFile::container_type::iterator> units;
+      for (CGDFile::container_type::iterator unit = cgd_file;
+          unit != CGDFile::container.end() && unit->in_corpus() && unit->corpus() == cgd_file->corpus(); ++unit)
+	units.push_back(unit);
+      LineParser<Handler> parser(cgd_file, &units, handler, filter, input_file);
+      split_lines(begin, begin + size, parser);
+    }
+    else
+    {
+      LineParser<Handler> parser(cgd_file, NULL, handler, filter, input_file);
+      if (format == cgd_format_text)
+	// Split the records in place; there is no limit on the length of a line.
+	split_lines(begin, begin + size, parser);
+      else
+      {
+	std::auto_ptr<Decompressor> input(Decompressor::create(format, begin, size, cgd_file->long_name()));
+	split_lines(*input, parser);
+      }
+    }
+  }
+  catch (std::runtime_error const&)
+  {
+    // Don't let other threads wait for this file forever.
+    if (first)
+      duplicates.done(first);
+    reader.release(index);
+    throw;
+  }
+  if (first)
+    duplicates.done(first);
+  reader.release(index);
+}
+
+// Apply record of input file cgd_file. If first is not NULL, collect the defined function in it.
+void apply(CGDRecord const& record, CGDFile::container_type::iterator cgd_file, Contents* first)
+{
+  CGDRecord::function_id function = record.apply(cgd_file);
+  if (first && record.type == 'F' && !Contents::is_anonymous(record))
+    first->definitions.push_back(function);
+}
+
+// Process input file 'copy', that has the same contents as input_file.original.
+void apply_copy(InputFile const& input_file, CGDFile::container_type::iterator copy, RecordFilter& filter, SkippedDuplicates& skipped)
+{
+  Contents const& original(*input_file.original);
+  Dout(dc::notice, copy->long_name() << " is a copy of " << original.cgd_file->long_name() << '.');
+  filter.add_excluded(original.replay(copy, filter));
+  ++skipped.files;
+  skipped.bytes += input_file.bytes;
+  skipped.records += original.records - original.anonymous.size();
+}
+
+// Handler that immediately applies each record.
+struct apply_record {
+  CGDFile::container_type::iterator M_cgd_file;
+  Contents* const& M_first;
+  apply_record(CGDFile::container_type::iterator cgd_file, Contents* const& first) : M_cgd_file(cgd_file), M_first(first) { }
+  void operator()(CGDRecord const& record) { apply(record, M_cgd_file, M_first); }
+  void set_cgd_file(CGDFile::container_type::iterator cgd_file) { M_cgd_file = cgd_file; }
+};
+
+// The parsed records of one .cgd file.
+struct Shard : public InputFile {
+  std::vector<CGDRecord> records;
+  // The index in 'records' at which the records of each unit of a corpus start.
+  std::vector<std::pair<size_t, CGDFile::container_type::iterator> > sections;
+  bool done;			// Set when the file was parsed (or failed to parse).
+  bool failed;			// Set when parsing threw an exception.
+  std::string error;		// The what() of that exception.
+  Shard(void) : done(false), failed(false) { }
+};
+
+// Handler that stores each record in a shard.
+struct store_record {
+  Shard& M_shard;
+  store_record(Shard& shard) : M_shard(shard) { }
+  void operator()(CGDRecord const& record)
+  {
+    M_shard.records.push_back(record);
+    if (record.type == 'F')
+    {
+      // Don't keep a copy of the unused fields of the reused record.
+      M_shard.records.back().callee.clear();
+      M_shard.records.back().callee_file.clear();
+    }
+  }
+  void set_cgd_file(CGDFile::container_type::iterator cgd_file)
+  {
+    M_shard.sections.push_back(std::pair<size_t, CGDFile::container_type::iterator>(M_shard.records.size(), cgd_file));
+  }
+};
+
+// State shared between the worker threads, that parse the .cgd files into shards,
+// and the main thread, that merges the shards into the global containers.
+//
+// The shards are merged in the order of CGDFile::container, so that the result is
+// exactly the same as when reading all files with a single thread.
+struct Ingestion {
+  pthread_mutex_t mutex;
+  pthread_cond_t cond;
+  InputReader* reader;
+  RecordFilter const* filter;
+  std::vector<CGDFile::container_type::iterator> files;
+  std::vector<Shard> shards;	// One per file.
+  size_t next;			// Index of the next file that should be parsed.
+  size_t merged;		// Number of shards merged so far.
+  size_t max_ahead;		// Maximum number of parsed, but not yet merged, shards.
+  DuplicateFilter duplicates;	// Uses mutex and cond.
+  Ingestion(void) : duplicates(&mutex, &cond) { }
+};
+
+void* ingestion_worker(void* arg)
+{
+  Debug(debug::init_thread());
+  Ingestion& ingestion(*static_cast<Ingestion*>(arg));
+  pthread_mutex_lock(&ingestion.mutex);
+  for(;;)
+  {
+    // Don't run too far ahead of the main thread, or we'd keep all records in memory.
+    while (ingestion.next < ingestion.files.size() && ingestion.next >= ingestion.merged + ingestion.max_ahead)
+      pthread_cond_wait(&ingestion.cond, &ingestion.mutex);
+    if (ingestion.next == ingestion.files.size())
+      break;
+    size_t index = ingestion.next++;
+    pthread_mutex_unlock(&ingestion.mutex);
+    Shard& shard(ingestion.shards[index]);
+    try
+    {
+      store_record handler(shard);
+      for_each_record(*ingestion.reader, index, ingestion.files[index], ingestion.duplicates, *ingestion.filter, handler, shard);
+    }
+    catch (std::runtime_error const& error)
+    {
+      shard.failed = true;
+      shard.error = error.what();
+    }
+    pthread_mutex_lock(&ingestion.mutex);
+    shard.done = true;
+    pthread_cond_broadcast(&ingestion.cond);
+  }
+  pthread_mutex_unlock(&ingestion.mutex);
+  return NULL;
+}
+
+void print_progress(int verbose, CGDFile const& cgd_file)
+{
+  if (verbose == 1)
+    std::cout << '.' << std::flush;
+  else if (verbose > 1)
+  {
+    if (cgd_file.has_source_file())
+      std::cout << " [" << cgd_file.source_file().short_name() << "]\n";
+    else
+      std::cout << '\n';
+  }
+}
+
+// The largest frame of a stream that is accepted. A frame contains one compilation unit,
+// so anything larger is a corrupt or truncated header rather than a real frame.
+size_t const max_frame_length = 1024 * 1024 * 1024;
+
+// Buffered reading from a file descriptor.
+class StreamInput {
+private:
+  int M_fd;
+  std::string const& M_name;
+  std::vector<char> M_buffer;
+  size_t M_begin;		// The first unread byte in M_buffer.
+  size_t M_end;			// The end of the data in M_buffer.
+
+public:
+  StreamInput(int fd, std::string const& name) : M_fd(fd), M_name(name), M_buffer(65536), M_begin(0), M_end(0) { }
+
+  // Read the next line, without the newline. Returns false at end-of-file.
+  bool getline(std::string& line);
+
+  // Read exactly 'length' bytes into data.
+  void read(std::vector<char>& data, size_t length);
+
+private:
+  // Read more data into the buffer. Returns false at end-of-file.
+  bool fill(void);
+};
+
+bool StreamInput::fill(void)
+{
+  M_begin = M_end = 0;
+  ssize_t len;
+  while ((len = ::read(M_fd, &M_buffer[0], M_buffer.size())) == -1 && errno == EINTR);
+  if (len == -1)
+    THROW_EXCEPTION(std::runtime_error("read: " + M_name + ": " + strerror(errno)), "StreamInput::fill(): read failed");
+  M_end = len;
+  return len > 0;
+}
+
+bool StreamInput::getline(std::string& line)
+{
+  line.clear();
+  for(;;)
+  {
+    if (M_begin == M_end && !fill())
+      return !line.empty();
+    char const* begin = &M_buffer[M_begin];
+    char const* eol = static_cast<char const*>(memchr(begin, '\n', M_end - M_begin));
+    if (eol)
+    {
+      line.append(begin, eol - begin);
+      M_begin += eol - begin + 1;
+      return true;
+    }
+    line.append(begin, M_end - M_begin);
+    M_begin = M_end;
+  }
+}
+
+void StreamInput::read(std::vector<char>& data, size_t length)
+{
+  data.resize(length);
+  size_t done = 0;
+  while (done < length)
+  {
+    if (M_begin == M_end && !fill())
+      THROW_EXCEPTION(std::runtime_error(M_name + ": unexpected end of stream."), "StreamInput::read(): EOF");
+    size_t len = std::min(length - done, M_end - M_begin);
+    memcpy(&data[done], &M_buffer[M_begin], len);
+    M_begin += len;
+    done += len;
+  }
+}
+
+// A record of the stream, that contains an anonymous namespace.
+//
+// The names of anonymous namespaces are made unique with the short name of their
+// cgd file, but short names can only be generated once all cgd files are known.
+struct DeferredRecord {
+  CGDFile::container_type::iterator cgd_file;
+  CGDRecord record;
+  DeferredRecord(CGDFile::container_type::iterator f, CGDRecord const& r) : cgd_file(f), record(r) { }
+};
+
+// Parses the lines of one frame of the stream; applies the records or defers them.
+struct StreamLineParser {
+  CGDFile::container_type::iterator M_cgd_file;
+  std::vector<DeferredRecord>& M_deferred;
+  RecordFilter& M_filter;
+  int M_line_nr;
+  CGDRecord M_record;
+
+  StreamLineParser(CGDFile::container_type::iterator cgd_file, std::vector<DeferredRecord>& deferred, RecordFilter& filter) :
+      M_cgd_file(cgd_file), M_deferred(deferred), M_filter(filter), M_line_nr(0) { }
+
+  void operator()(char const* line, size_t len)
+  {
+    M_record.parse_raw(line, len, M_cgd_file->long_name(), ++M_line_nr);
+    if (M_filter.excludes(M_record, M_cgd_file->directory().str()))
+    {
+      M_filter.add_excluded(1);
+      return;
+    }
+    bool is_call = M_record.type == 'C';
+    if (M_record.function.find("<unnamed>::") != std::string::npos ||
+        (is_call && M_record.callee.find("<unnamed>::") != std::string::npos))
+      M_deferred.push_back(DeferredRecord(M_cgd_file, M_record));
+    else
+      M_record.apply(M_cgd_file);
+  }
+};
+
+} // namespace
+
+double read_cgd_files(int verbose, int jobs, io_backend_type io_backend, RecordFilter& filter, SkippedDuplicates& skipped)
+{
+  double total_bytes = 0;
+
+  std::vector<CGDFile::container_type::iterator> input_files;
+  get_input_files(input_files);
+  std::vector<std::string const*> filenames;
+  for (std::vector<CGDFile::container_type::iterator>::iterator iter = input_files.begin(); iter != input_files.end(); ++iter)
+    filenames.push_back(&(*iter)->input_file());
+  std::auto_ptr<InputReader> reader(create_input_reader(io_backend, filenames));
+  Dout(dc::notice, "Reading the input files using " << reader->name() << '.');
+
+  if (jobs <= 1)
+  {
+    DuplicateFilter duplicates(NULL, NULL);
+    for (size_t index = 0; index < input_files.size(); ++index)
+    {
+      CGDFile::container_type::iterator iter = input_files[index];
+      if (verbose > 1)
+	std::cout << "  " << iter->input_file() << std::flush;
+      InputFile input_file;
+      apply_record handler(iter, input_file.first);
+      for_each_record(*reader, index, iter, duplicates, filter, handler, input_file);
+      if (input_file.original)
+	apply_copy(input_file, iter, filter, skipped);
+      filter.add_excluded(input_file.excluded);
+      total_bytes += input_file.bytes;
+      print_progress(verbose, *iter);
+    }
+    CGDRecord::finish_ingestion(jobs);
+    return total_bytes;
+  }
+
+  Ingestion ingestion;
+  pthread_mutex_init(&ingestion.mutex, NULL);
+  pthread_cond_init(&ingestion.cond, NULL);
+  ingestion.reader = reader.get();
+  ingestion.filter = &filter;
+  ingestion.files.swap(input_files);
+  ingestion.shards.resize(ingestion.files.size());
+  ingestion.next = 0;
+  ingestion.merged = 0;
+  ingestion.max_ahead = 4 * jobs;
+
+  std::vector<pthread_t> threads(jobs);
+  for (int i = 0; i < jobs; ++i)
+    if (pthread_create(&threads[i], NULL, ingestion_worker, &ingestion) != 0)
+      DoutFatal(dc::fatal|error_cf, "pthread_create");
+
+  std::string error;
+  for (size_t index = 0; index < ingestion.files.size(); ++index)
+  {
+    Shard& shard(ingestion.shards[index]);
+    pthread_mutex_lock(&ingestion.mutex);
+    while (!shard.done)
+      pthread_cond_wait(&ingestion.cond, &ingestion.mutex);
+    pthread_mutex_unlock(&ingestion.mutex);
+    CGDFile::container_type::iterator cgd_file = ingestion.files[index];
+    if (verbose > 1)
+      std::cout << "  " << cgd_file->input_file() << std::flush;
+    if (shard.failed)
+    {
+      error = shard.error;
+      break;
+    }
+    if (shard.original)
+      apply_copy(shard, cgd_file, filter, skipped);
+    filter.add_excluded(shard.excluded);
+    CGDFile::container_type::iterator unit = cgd_file;
+    std::vector<std::pair<size_t, CGDFile::container_type::iterator> >::const_iterator section = shard.sections.begin();
+    for (size_t record = 0; record < shard.records.size(); ++record)
+    {
+      for (; section != shard.sections.end() && section->first == record; ++section)
+	unit = section->second;
+      apply(shard.records[record], unit, shard.first);
+    }
+    total_bytes += shard.bytes;
+    // Free the memory of this shard.
+    std::vector<CGDRecord>().swap(shard.records);
+    std::vector<std::pair<size_t, CGDFile::container_type::iterator> >().swap(shard.sections);
+    print_progress(verbose, *cgd_file);
+    pthread_mutex_lock(&ingestion.mutex);
+    ++ingestion.merged;
+    pthread_cond_broadcast(&ingestion.cond);
+    pthread_mutex_unlock(&ingestion.mutex);
+  }
+
+  // Stop the workers (only needed when we stopped because of an error).
+  pthread_mutex_lock(&ingestion.mutex);
+  ingestion.next = ingestion.files.size();
+  pthread_cond_broadcast(&ingestion.cond);
+  pthread_mutex_unlock(&ingestion.mutex);
+  for (int i = 0; i < jobs; ++i)
+    pthread_join(threads[i], NULL);
+  pthread_cond_destroy(&ingestion.cond);
+  pthread_mutex_destroy(&ingestion.mutex);
+
+  if (!error.empty())
+    THROW_EXCEPTION(std::runtime_error(error), "read_cgd_files: " << error);
+
+  CGDRecord::finish_ingestion(jobs);
+  return total_bytes;
+}
+
+double read_cgd_stream(int verbose, int jobs, std::string const& stream, RecordFilter& filter)
+{
+  int fd = 0;
+  if (stream != "-")
+  {
+    // Open a FIFO also for writing, so that we don't get an end-of-file
+    // every time that the last compiler wrapper closes it.
+    struct stat statbuf;
+    bool is_fifo = stat(stream.c_str(), &statbuf) == 0 && S_ISFIFO(statbuf.st_mode);
+    fd = open(stream.c_str(), is_fifo ? O_RDWR : O_RDONLY);
+    if (fd == -1)
+      THROW_EXCEPTION(std::runtime_error(stream + ": " + strerror(errno)), "read_cgd_stream: open failed");
+  }
+
+  double total_bytes = 0;
+  std::vector<DeferredRecord> deferred;
+  std::set<std::string> paths;
+  try
+  {
+    StreamInput input(fd, stream);
+    std::string header;
+    std::vector<char> data;
+    while (input.getline(header))
+    {
+      if (header.empty())
+	continue;
+      if (header == "#end")
+	break;
+      char* length_end = NULL;
+      unsigned long length = 0;
+      errno = 0;
+      if (header.compare(0, 5, "#cgd ") == 0 && header[5] >= '0' && header[5] <= '9')
+	length = strtoul(header.c_str() + 5, &length_end, 10);
+      if (!length_end || *length_end != ' ' || length_end[1] != '/' || errno == ERANGE || length > max_frame_length)
+	THROW_EXCEPTION(std::runtime_error(stream + ": expected \"#cgd <length> <absolute path>\", got \"" + header + "\"."),
+	    "read_cgd_stream: bad frame header");
+      std::string path(length_end + 1);
+      input.read(data, length);
+      if (!paths.insert(path).second)
+      {
+	std::cerr << "WARNING: " << stream << ": ignoring a second frame for \"" << path << "\"." << std::endl;
+	continue;
+      }
+      CGDFile::container_type::iterator cgd_file = add_cgd_file(path);
+      if (verbose > 1)
+	std::cout << "  " << path << std::flush;
+      StreamLineParser parser(cgd_file, deferred, filter);
+      if (length > 0)
+	split_lines(&data[0], &data[0] + length, parser);
+      total_bytes += length;
+      print_progress(verbose, *cgd_file);
+    }
+  }
+  catch (std::runtime_error const&)
+  {
+    if (fd != 0)
+      close(fd);
+    throw;
+  }
+  if (fd != 0)
+    close(fd);
+
+  if (CGDFile::container.empty())
+    THROW_EXCEPTION(no_cgd_files(), "read_cgd_stream(): No frames in \"" << stream << "\"");
+  CGDFile::generate_short_names();
+  for (std::vector<DeferredRecord>::iterator iter = deferred.begin(); iter != deferred.end(); ++iter)
+  {
+    CGDRecord::rewrite_unnamed(iter->record.function, *iter->cgd_file);
+    if (iter->record.type == 'C')
+      CGDRecord::rewrite_unnamed(iter->record.callee, *iter->cgd_file);
+    iter->record.apply(iter->cgd_file);
+  }
+  CGDRecord::finish_ingestion(jobs);
+  return total_bytes;
+}
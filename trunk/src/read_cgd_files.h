@@ -0,0 +1,47 @@
+// cppgraph -- C++ call graph analyzer
+//
+//! @file read_cgd_files.h
+//! @brief This file contains the declaration of function read_cgd_files.
+//
+// Copyright (C) 2006, by Timmy <timmy1992@gmail.com>
+//
+// This file may be distributed under the terms of the Q Public License
+// version 1.0 as appearing in the file LICENSE.QPL included in the
+// packaging of this file.
+
+#ifndef READ_CGD_FILES_H
+#define READ_CGD_FILES_H
+
+#include <string>
+#include "InputReader.h"
+
+class RecordFilter;
+
+// The input files that were not parsed, because they are byte-identical to an earlier input file.
+struct SkippedDuplicates {
+  size_t files;
+  double bytes;
+  size_t records;
+  SkippedDuplicates(void) : files(0), bytes(0), records(0) { }
+};
+
+// Read and process all files in CGDFile::container, using 'jobs' threads to parse them.
+// The files are read with 'io_backend'; records excluded by 'filter' are dropped.
+// Copies of an input file that was already read are skipped where that doesn't
+// change the result; they are counted in 'skipped'.
+// Returns the total number of bytes read.
+double read_cgd_files(int verbose, int jobs, io_backend_type io_backend, RecordFilter& filter, SkippedDuplicates& skipped);
+
+// Read and process a stream of framed .cgd files from 'stream' (a file, a FIFO, or "-" for stdin),
+// adding each of them to CGDFile::container. A frame is a header line
+//
+//   #cgd <length> <path>
+//
+// followed by <length> bytes of records, where <path> is the absolute path
+// that the .cgd file would have had on disk. The stream ends at end-of-file
+// or at a line "#end". Records excluded by 'filter' are dropped. Up to 'jobs'
+// threads are used to build the containers at the end.
+// Returns the total number of bytes of records read.
+double read_cgd_stream(int verbose, int jobs, std::string const& stream, RecordFilter& filter);
+
+#endif // READ_CGD_FILES_H
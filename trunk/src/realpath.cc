@@ -11,11 +11,87 @@
 
 #include "sys.h"
 #include <string>
+#include <map>
 #include <cerrno>
+#include <pthread.h>
 #include "exceptions.h"
 
 int const path_max = 4096;
 
+namespace {
+
+// A canonical path (without symbolic links) that was passed to readlink before.
+struct PathNode {
+  PathNode* parent;
+  std::map<std::string, PathNode*> children;	// Indexed by the last component of their path.
+  bool is_symlink;
+  std::string target;				// The contents of the symbolic link, if is_symlink.
+
+  PathNode(PathNode* p) : parent(p), is_symlink(false) { }
+  ~PathNode()
+  {
+    for (std::map<std::string, PathNode*>::iterator iter = children.begin(); iter != children.end(); ++iter)
+      delete iter->second;
+  }
+};
+
+// Remembers the result of readlink for every path prefix that realpath resolved, so that
+// the same prefixes are only read once. The root of the trie is "/".
+class PathTrie {
+private:
+  PathNode M_root;
+  pthread_mutex_t M_mutex;			// Protects the children of all nodes.
+
+public:
+  PathTrie(void) : M_root(NULL) { pthread_mutex_init(&M_mutex, NULL); }
+  ~PathTrie() { pthread_mutex_destroy(&M_mutex); }
+
+  PathNode* root(void) { return &M_root; }
+
+  // Return the child 'name' of node, where path is the path of that child.
+  // Calls readlink(path) the first time.
+  // @throws std::runtime_error
+  PathNode* child(PathNode* node, std::string const& name, std::string const& path);
+};
+
+PathNode* PathTrie::child(PathNode* node, std::string const& name, std::string const& path)
+{
+  pthread_mutex_lock(&M_mutex);
+  std::map<std::string, PathNode*>::iterator iter = node->children.find(name);
+  PathNode* known = iter == node->children.end() ? NULL : iter->second;
+  pthread_mutex_unlock(&M_mutex);
+  if (known)
+    return known;
+
+  char buf[path_max];
+  int len = readlink(path.c_str(), buf, sizeof(buf));
+  if (len >= (int)sizeof(buf))
+  {
+    errno = ERANGE;
+    len = -1;
+  }
+  if (len == -1 && errno != EINVAL)
+    THROW_EXCEPTION(std::runtime_error(path + ": " + strerror(errno)),
+	"readlink(\"" << path << "\", " << (void*)buf << ", " << sizeof(buf) << ") == -1: " << strerror(errno));
+  PathNode* new_node = new PathNode(node);
+  if (len != -1)
+  {
+    new_node->is_symlink = true;
+    new_node->target.assign(buf, len);
+  }
+  pthread_mutex_lock(&M_mutex);
+  std::pair<std::map<std::string, PathNode*>::iterator, bool> result =
+      node->children.insert(std::pair<std::string, PathNode*>(name, new_node));
+  pthread_mutex_unlock(&M_mutex);
+  if (!result.second)		// Another thread was first.
+    delete new_node;
+  return result.first->second;
+}
+
+PathTrie path_trie;
+
+} // namespace
+
 //! \brief Return canonical path name of \a path.
 //
 // realpath expands all symbolic links and resolves references to '/./', '/../' and extra '/' characters in
@@ -24,11 +100,14 @@ int const path_max = 4096;
 // Nor will it  end on a slash: if the result is the root then the returned path is empty,
 // and unless the result is empty, it will always start with a slash.
 //
+// Symbolic links are only read once: the result of readlink is cached per path prefix.
+// This function is thread-safe.
+//
 // @throws std::runtime_error
 
 std::string realpath(std::string const& path)
 {
-  // Buffer for getcwd and readlink.
+  // Buffer for getcwd.
   char buf[path_max];
 
   std::string full_path;
@@ -46,6 +125,7 @@ std::string realpath(std::string const& path)
   }
 
   std::string result;
+  PathNode* node = path_trie.root();		// The node of result.
   std::string::iterator slash1 = full_path.begin();
   for (std::string::iterator slash2 = slash1; slash1 != full_path.end(); slash1 = slash2)
   {
@@ -71,36 +151,32 @@ std::string realpath(std::string const& path)
 	std::string::iterator iter = result.end();
 	while (*--iter != '/');
 	result.erase(iter, result.end());
+	node = node->parent;
       }
       continue;
     }
     result += full_path.substr(slash1 - full_path.begin(), dirlen);
-    int len = readlink(result.c_str(), buf, sizeof(buf));
-    if (len >= (int)sizeof(buf))
-    {
-      errno = ERANGE;
-      len = -1;
-    }
-    else if (len != -1)
+    PathNode* next = path_trie.child(node, full_path.substr(slash1 - full_path.begin() + 1, dirlen - 1), result);
+    if (next->is_symlink)
     {
-      if (buf[0] == '/')
+      std::string const& target(next->target);
+      if (target[0] == '/')
       {
         result.clear();
-	full_path.replace(full_path.begin(), slash2, buf, len);
+	node = path_trie.root();
+	full_path.replace(full_path.begin(), slash2, target);
 	slash2 = full_path.begin();
       }
       else
       {
         result.erase(result.end() - dirlen, result.end());
 	size_t len1 = slash1 - full_path.begin();
-	full_path.replace(slash1 + 1, slash2, buf, len);
+	full_path.replace(slash1 + 1, slash2, target);
 	slash2 = full_path.begin() + len1;
       }
       continue;
     }
-    if (len == -1 && errno != EINVAL)
-      THROW_EXCEPTION(std::runtime_error(result + ": " + strerror(errno)),
-	  "readlink(\"" << result << "\", " << (void*)buf << ", " << sizeof(buf) << ") == -1: " << strerror(errno));
+    node = next;
   }
   return result;
 }
@@ -169,13 +169,13 @@ inline boost::serialization::nvp<IteratorWrapper<Container, typename Container::
 }
 
 // Specialization for std::set, because for that container, the iterator and const_iterator are the same type!
-template<typename T>
-inline boost::serialization::nvp<IteratorWrapper<std::set<T>, typename std::set<T>::const_iterator> > const
-    serialization_iterator_nvp(std::set<T>& container, char const* name, typename std::set<T>::const_iterator const& t)
+template<typename T, typename Compare, typename Allocator>
+inline boost::serialization::nvp<IteratorWrapper<std::set<T, Compare, Allocator>, typename std::set<T, Compare, Allocator>::const_iterator> > const
+    serialization_iterator_nvp(std::set<T, Compare, Allocator>& container, char const* name, typename std::set<T, Compare, Allocator>::const_iterator const& t)
 {
-  IteratorWrapper<std::set<T>, typename std::set<T>::const_iterator>
-      tmp(container, const_cast<typename std::set<T>::const_iterator&>(t));
-  return boost::serialization::nvp<IteratorWrapper<std::set<T>, typename std::set<T>::const_iterator> >(name, tmp);
+  IteratorWrapper<std::set<T, Compare, Allocator>, typename std::set<T, Compare, Allocator>::const_iterator>
+      tmp(container, const_cast<typename std::set<T, Compare, Allocator>::const_iterator&>(t));
+  return boost::serialization::nvp<IteratorWrapper<std::set<T, Compare, Allocator>, typename std::set<T, Compare, Allocator>::const_iterator> >(name, tmp);
 }
 
 template<typename Container>
@@ -199,14 +199,14 @@ inline boost::serialization::nvp<VectorIteratorWrapper<Container, typename Conta
 }
 
 // Specialization for std::set, because for that container, the iterator and const_iterator are the same type!
-template<typename T>
-inline boost::serialization::nvp<VectorIteratorWrapper<std::set<T>, typename std::set<T>::const_iterator> > const
-    serialization_iterator_nvp(std::set<T>& container, char const* name,
-                               std::vector<typename std::set<T>::const_iterator> const& v)
+template<typename T, typename Compare, typename Allocator>
+inline boost::serialization::nvp<VectorIteratorWrapper<std::set<T, Compare, Allocator>, typename std::set<T, Compare, Allocator>::const_iterator> > const
+    serialization_iterator_nvp(std::set<T, Compare, Allocator>& container, char const* name,
+                               std::vector<typename std::set<T, Compare, Allocator>::const_iterator> const& v)
 {
-  VectorIteratorWrapper<std::set<T>, typename std::set<T>::const_iterator>
-      tmp(container, const_cast<std::vector<typename std::set<T>::const_iterator>&>(v));
-  return boost::serialization::nvp<VectorIteratorWrapper<std::set<T>, typename std::set<T>::const_iterator> >(name, tmp);
+  VectorIteratorWrapper<std::set<T, Compare, Allocator>, typename std::set<T, Compare, Allocator>::const_iterator>
+      tmp(container, const_cast<std::vector<typename std::set<T, Compare, Allocator>::const_iterator>&>(v));
+  return boost::serialization::nvp<VectorIteratorWrapper<std::set<T, Compare, Allocator>, typename std::set<T, Compare, Allocator>::const_iterator> >(name, tmp);
 }
 
 template<typename Container, typename INFO>
@@ -230,14 +230,14 @@ inline boost::serialization::nvp<MapIteratorWrapper<Container, typename Containe
 }
 
 // Specialization for std::set, because for that container, the iterator and const_iterator are the same type!
-template<typename T, typename INFO>
-inline boost::serialization::nvp<MapIteratorWrapper<std::set<T>, typename std::set<T>::const_iterator, INFO> > const
-    serialization_iterator_nvp(std::set<T>& container, char const* name,
-                               std::map<typename std::set<T>::const_iterator, INFO> const& m)
+template<typename T, typename Compare, typename Allocator, typename INFO>
+inline boost::serialization::nvp<MapIteratorWrapper<std::set<T, Compare, Allocator>, typename std::set<T, Compare, Allocator>::const_iterator, INFO> > const
+    serialization_iterator_nvp(std::set<T, Compare, Allocator>& container, char const* name,
+                               std::map<typename std::set<T, Compare, Allocator>::const_iterator, INFO> const& m)
 {
-  MapIteratorWrapper<std::set<T>, typename std::set<T>::const_iterator, INFO>
-      tmp(container, const_cast<std::map<typename std::set<T>::const_iterator, INFO>&>(m));
-  return boost::serialization::nvp<MapIteratorWrapper<std::set<T>, typename std::set<T>::const_iterator, INFO> >(name, tmp);
+  MapIteratorWrapper<std::set<T, Compare, Allocator>, typename std::set<T, Compare, Allocator>::const_iterator, INFO>
+      tmp(container, const_cast<std::map<typename std::set<T, Compare, Allocator>::const_iterator, INFO>&>(m));
+  return boost::serialization::nvp<MapIteratorWrapper<std::set<T, Compare, Allocator>, typename std::set<T, Compare, Allocator>::const_iterator, INFO> >(name, tmp);
 }
 
 #endif // SERIALIZATION_H